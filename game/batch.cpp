@@ -0,0 +1,31 @@
+#include "../lib/include/BatchRunner.hpp"
+#include <iostream>
+#include <string>
+
+int main(int argc, char* argv[]) {
+    size_t matches = argc > 1 ? std::stoul(argv[1]) : 1000;
+    size_t threads = argc > 2 ? std::stoul(argv[2]) : 0;
+    size_t tick_limit = argc > 3 ? std::stoul(argv[3]) : 1000;
+    uint64_t seed = argc > 4 ? std::stoull(argv[4]) : 1;
+    try {
+        BatchRunner runner{{"../../data/Units/", "../../data/Skills/", "../../data/Schools/", "../../data/Summoners/Student.json", "../../data/Summoners/D.S.Telyakovskii.json", "../../data/Field/GameField.json"}, threads};
+        BatchReport report = runner.run(matches, seed, tick_limit);
+        for (const auto& match : report.matches) {
+            std::cout << match.index << " seed=" << match.seed << " ticks=" << match.ticks << " ";
+            if (!match.error.empty()) {
+                std::cout << "error: " << match.error;
+            } else if (match.winner == std::nullopt) {
+                std::cout << "draw";
+            } else {
+                std::cout << (match.winner == PLAYER ? "player" : "enemy");
+            }
+            std::cout << "\n";
+        }
+        std::cout << "\n" << report.matches.size() << " matches on " << report.threads << " threads in " << report.seconds << " s\n";
+        std::cout << report.matches_per_second() << " matches/s, " << report.ticks_per_second() << " ticks/s\n";
+        std::cout << "player " << report.wins(PLAYER) << ", enemy " << report.wins(ENEMY) << ", draws " << report.draws() << "\n";
+    }
+    catch (const std::exception& e) {
+        std::cout << e.what() << "\n\n";
+    }
+}
@@ -0,0 +1,24 @@
+#include "../lib/include/game.hpp"
+#include "../lib/include/CatalogFile.hpp"
+#include <iostream>
+#include <string>
+
+int main(int argc, char* argv[]) {
+    std::string units_dir = argc > 1 ? argv[1] : "../../data/Units/";
+    std::string skills_dir = argc > 2 ? argv[2] : "../../data/Skills/";
+    std::string schools_dir = argc > 3 ? argv[3] : "../../data/Schools/";
+    try {
+        std::string path = CatalogFile::default_path(units_dir);
+        CatalogReport report = CatalogFile::compile(units_dir, skills_dir, schools_dir, path);
+        for (const auto& error : report.errors) {
+            std::cout << error.file << ": " << error.message << "\n";
+        }
+        auto catalog = Game::read_schools_table(units_dir, skills_dir, schools_dir);
+        std::cout << path << ": " << catalog->units_amount() << " units, " << catalog->skills_amount() << " skills, " << catalog->schools_amount() << " schools\n";
+        std::cout << report.files << " files parsed on " << report.threads << " threads in " << report.parse_seconds << " s, compiled in " << report.seconds << " s, " << report.errors.size() << " errors\n";
+    }
+    catch (const std::exception& e) {
+        std::cout << e.what() << "\n\n";
+        return 1;
+    }
+}
@@ -0,0 +1,164 @@
+// Генератор встроенного каталога: переводит JSON из data/ в constexpr-таблицы
+// BuiltinCatalogData.hpp. Запускается сборкой при SUMMONERS_BUILTIN_CATALOG.
+#include "../../../json/single_include/nlohmann/json.hpp"
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+using json = nlohmann::json;
+
+namespace {
+    // JSON всех файлов каталога в порядке имён, чтобы вывод не зависел от файловой системы
+    std::vector<std::pair<std::string, json>> read_dir(const std::filesystem::path& dir) {
+        std::vector<std::filesystem::path> paths;
+        for (const auto& entry : std::filesystem::directory_iterator(dir)) {
+            if (entry.path().extension() == ".json") {
+                paths.push_back(entry.path());
+            }
+        }
+        std::sort(paths.begin(), paths.end());
+        std::vector<std::pair<std::string, json>> files;
+        for (const auto& path : paths) {
+            std::ifstream file(path);
+            try {
+                files.emplace_back(path.filename().string(), json::parse(file));
+            }
+            catch (const json::exception& e) {
+                throw std::runtime_error(path.string() + ": " + e.what());
+            }
+        }
+        return files;
+    }
+
+    std::string literal(const json& value) {
+        return json(value.get<std::string>()).dump();
+    }
+
+    std::string number(const json& value) {
+        if (!value.is_number()) {
+            throw std::runtime_error("Expected number, got " + value.dump());
+        }
+        return value.dump();
+    }
+
+    std::string kind_of(const std::string& type) {
+        static const std::unordered_map<std::string, std::string> kinds{{"Moral", "MORAL"}, {"Amoral", "AMORAL"}, {"Ressurection", "RESSURECTION"}, {"Kamikaze", "KAMIKAZE"}};
+        auto kind = kinds.find(type);
+        if (kind == kinds.end()) {
+            throw std::runtime_error("Unknown skill type " + type);
+        }
+        return kind->second;
+    }
+
+    void table(std::ostream& out, const std::string& type, const std::string& name, const std::vector<std::string>& rows) {
+        out << "inline constexpr std::array<" << type << ", " << rows.size() << "> " << name << "{{\n";
+        for (const auto& row : rows) {
+            out << "    " << row << ",\n";
+        }
+        out << "}};\n\n";
+    }
+}
+
+int main(int argc, char* argv[]) {
+    if (argc != 3) {
+        std::cerr << "Usage: " << argv[0] << " <data dir> <output header>\n";
+        return 2;
+    }
+    std::filesystem::path data = argv[1];
+    try {
+        std::vector<std::string> units;
+        std::unordered_map<std::string, size_t> unit_ids;
+        for (auto& [file, unit] : read_dir(data / "Units")) {
+            unit_ids[unit["name"]] = units.size();
+            bool moral = unit["morality"] != "NULL";
+            units.push_back("{" + literal(unit["name"]) + ", " + literal(unit["school"]) + ", " + number(unit["max_amount"]) + ", " + number(unit["initiative"]) + ", "
+                + number(unit["damage"]) + ", " + number(unit["entity_hp"]) + ", " + number(unit["speed"]) + ", " + number(unit["defence"]) + ", "
+                + number(unit["xp_for_destroy"]) + ", " + (moral ? "true" : "false") + ", " + (moral ? number(unit["morality"]) : "0.0") + "}");
+        }
+        std::vector<std::string> skills;
+        std::unordered_map<std::string, size_t> skill_ids;
+        for (auto& [file, skill] : read_dir(data / "Skills")) {
+            auto unit = unit_ids.find(skill["entity"]);
+            if (unit == unit_ids.end()) {
+                throw std::runtime_error(file + ": unknown unit " + skill["entity"].get<std::string>());
+            }
+            skill_ids[skill["name"]] = skills.size();
+            skills.push_back("{" + literal(skill["name"]) + ", " + std::to_string(unit->second) + ", " + kind_of(skill["type"]) + ", " + number(skill["min_knowledge"]) + ", "
+                + number(skill["required_energy"]) + ", " + number(skill["knowledge_coefficient"]) + "}");
+        }
+        auto school_files = read_dir(data / "Schools");
+        std::vector<std::string> schools, school_skills, dominants;
+        std::vector<std::string> names;
+        for (auto& [file, school] : school_files) {
+            size_t first_skill = school_skills.size(), first_dominant = dominants.size();
+            for (auto& name : school["skills"]) {
+                auto skill = skill_ids.find(name);
+                if (skill == skill_ids.end()) {
+                    throw std::runtime_error(file + ": unknown skill " + name.get<std::string>());
+                }
+                school_skills.push_back(std::to_string(skill->second));
+            }
+            for (auto& name : school["dominant_for"]) {
+                dominants.push_back(literal(name));
+            }
+            names.push_back(school["name"]);
+            schools.push_back("{" + literal(school["name"]) + ", " + std::to_string(first_skill) + ", " + std::to_string(school_skills.size() - first_skill) + ", "
+                + std::to_string(first_dominant) + ", " + std::to_string(dominants.size() - first_dominant) + "}");
+        }
+        // Матрица множителей урона по тем же правилам, что SchoolsTable::coefficient
+        auto dominates = [&](size_t one, size_t two) {
+            const json& list = school_files[one].second["dominant_for"];
+            return std::find(list.begin(), list.end(), names[two]) != list.end();
+        };
+        std::vector<std::string> coefficients;
+        for (size_t i = 0; i < names.size(); ++i) {
+            for (size_t j = 0; j < names.size(); ++j) {
+                coefficients.push_back(dominates(i, j) ? "DOMINANT_COEFFICIENT" : dominates(j, i) ? "SUBMISSIVE_COEFFICIENT" : "1.0");
+            }
+        }
+        std::vector<std::string> summoners, knowledge;
+        for (auto& [file, summoner] : read_dir(data / "Summoners")) {
+            size_t first_knowledge = knowledge.size();
+            for (auto& school : summoner["schools_knowledge"]) {
+                knowledge.push_back("{" + literal(school[0]) + ", " + number(school[1]) + "}");
+            }
+            summoners.push_back("{" + json(file).dump() + ", " + literal(summoner["name"]) + ", " + number(summoner["initiative"]) + ", " + number(summoner["damage"]) + ", "
+                + number(summoner["max_hp"]) + ", " + number(summoner["accumulation_coefficient"]) + ", " + number(summoner["max_energy"]) + ", "
+                + std::to_string(first_knowledge) + ", " + std::to_string(knowledge.size() - first_knowledge) + "}");
+        }
+        std::ostringstream out;
+        out << "// Сгенерировано catalog_codegen из JSON в data/, не редактировать\n";
+        out << "#ifndef BUILTIN_CATALOG_DATA_HPP\n#define BUILTIN_CATALOG_DATA_HPP\n\n#include <array>\n#include <cstdint>\n#include <string_view>\n\n";
+        out << "namespace builtin_data {\n\n";
+        table(out, "BuiltinUnit", "units", units);
+        table(out, "BuiltinSkill", "skills", skills);
+        table(out, "uint32_t", "school_skills", school_skills);
+        table(out, "std::string_view", "dominants", dominants);
+        table(out, "BuiltinSchool", "schools", schools);
+        table(out, "double", "coefficients", coefficients);
+        table(out, "BuiltinKnowledge", "knowledge", knowledge);
+        table(out, "BuiltinSummoner", "summoners", summoners);
+        out << "}\n\n#endif\n";
+        std::filesystem::path output = argv[2];
+        std::filesystem::create_directories(output.parent_path());
+        std::filesystem::path temporary = output;
+        temporary += ".tmp";
+        {
+            std::ofstream file(temporary, std::ios::trunc);
+            file << out.str();
+            if (!file.flush()) {
+                throw std::runtime_error("Can't write " + temporary.string());
+            }
+        }
+        std::filesystem::rename(temporary, output);
+    }
+    catch (const std::exception& e) {
+        std::cerr << "catalog_codegen: " << e.what() << "\n";
+        return 1;
+    }
+}
@@ -1,8 +1,15 @@
 #include "../lib/include/game.hpp"
 #include <iostream> 
+#include <string>
 
-int main() {
+int main(int argc, char* argv[]) {
+    size_t autosave_interval = argc > 1 ? std::stoul(argv[1]) : DEFAULT_AUTOSAVE_INTERVAL;
+    size_t autosave_retained = argc > 2 ? std::stoul(argv[2]) : DEFAULT_AUTOSAVE_RETAINED;
     Game game{"../../data/Units/", "../../data/Skills/", "../../data/Schools/", "../../data/Summoners/Student.json", "../../data/Summoners/D.S.Telyakovskii.json", "../../data/Field/GameField.json"};
+    for (const auto& error : game.catalog_report().errors) {
+        std::cerr << error.file << ": " << error.message << "\n";
+    }
+    game.set_autosaver(std::make_shared<Autosaver>("../../data/UserSaves/", autosave_interval, autosave_retained));
     try {
         game.manager().start_menu(game, "../../data/Units/");
         while (game.is_active()) {
@@ -0,0 +1,112 @@
+#ifndef AUTOSAVER_HPP
+#define AUTOSAVER_HPP
+
+/**
+ * \file Autosaver.hpp
+ * \brief Периодическое автосохранение снимков игры в фоновом потоке.
+ */
+
+#define DEFAULT_AUTOSAVE_INTERVAL 50
+#define DEFAULT_AUTOSAVE_RETAINED 5
+#define AUTOSAVE_PREFIX "autosave-"
+
+#include "SaveFile.hpp"
+#include <condition_variable>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+/**
+ * \class Autosaver
+ * \brief Записывает снимки игры на диск в собственном потоке.
+ *
+ * Игра снимает SaveSnapshot в своём потоке и отдаёт его через submit; запись,
+ * fsync и переименование идут в фоне, так что тики не ждут диска. Если поток
+ * записи не успевает, ожидающий снимок заменяется более новым. После записи в
+ * каталоге остаются только retained последних автосохранений.
+ *
+ * Имена файлов начинаются с порядкового номера, продолжающего номера уже лежащих
+ * в каталоге автосохранений, поэтому порядок не зависит ни от часов, ни от номера тика.
+ */
+class Autosaver {
+    public:
+        /**
+        * \brief Конструктор, запускающий поток записи.
+        *
+        * \param dir Каталог автосохранений.
+        * \param interval Сохранять каждые interval тиков; 0 выключает автосохранение.
+        * \param retained Сколько последних автосохранений хранить; 0 — хранить все.
+        */
+        explicit Autosaver(std::string dir, size_t interval = DEFAULT_AUTOSAVE_INTERVAL, size_t retained = DEFAULT_AUTOSAVE_RETAINED);
+        Autosaver(const Autosaver&) = delete;
+        Autosaver& operator=(const Autosaver&) = delete;
+        /**
+        * \brief Дописывает ожидающий снимок и останавливает поток.
+        */
+        ~Autosaver();
+        size_t interval() const { return interval_; }
+        size_t retained() const { return retained_; }
+        /**
+        * \brief Нужно ли сохранять после тика ticks.
+        */
+        bool due(uint64_t ticks) const { return interval_ != 0 && ticks % interval_ == 0; }
+        /**
+        * \brief Ставит снимок в очередь записи и сразу возвращается.
+        *
+        * \param ticks Номер тика снимка, входит в имя файла после порядкового номера.
+        */
+        void submit(uint64_t ticks, std::shared_ptr<const SaveSnapshot> snapshot);
+        /**
+        * \brief Ждёт, пока все поставленные снимки будут записаны.
+        */
+        void flush();
+        /**
+        * \brief Число записанных автосохранений.
+        */
+        size_t written() const;
+        /**
+        * \brief Число снимков, заменённых более новыми до записи.
+        */
+        size_t dropped() const;
+        /**
+        * \brief Последняя ошибка записи или пустая строка.
+        */
+        std::string last_error() const;
+        /**
+        * \brief Путь к последнему записанному автосохранению или пустая строка.
+        */
+        std::string last_path() const;
+    private:
+        struct Job {
+            std::string path;
+            std::shared_ptr<const SaveSnapshot> snapshot;
+        };
+        std::string dir_;
+        size_t interval_;
+        size_t retained_;
+        mutable std::mutex mutex_;
+        std::condition_variable wake_;
+        std::condition_variable idle_;
+        std::unique_ptr<Job> pending_;
+        bool writing_ = false;
+        bool stopping_ = false;
+        size_t written_ = 0;
+        size_t dropped_ = 0;
+        std::string last_error_;
+        std::string last_path_;
+        uint64_t sequence_ = 0;     ///< Номер последнего поставленного автосохранения
+        std::thread thread_;
+        void work_();
+        /**
+        * \brief Автосохранения каталога с их номерами, от старых к новым.
+        */
+        std::vector<std::pair<uint64_t, std::filesystem::path>> saves_() const;
+        void prune_() const;
+};
+
+#endif
@@ -0,0 +1,88 @@
+#ifndef BATCH_RUNNER_HPP
+#define BATCH_RUNNER_HPP
+
+/**
+ * \file BatchRunner.hpp
+ * \brief Пакетный прогон партий ИИ против ИИ без терминального ввода-вывода.
+ */
+
+#include "game.hpp"
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+/**
+ * \brief Пути к каталогу, призывателям и полю, из которых собирается каждая партия.
+ */
+struct MatchConfig {
+    std::string units_dir;
+    std::string skills_dir;
+    std::string schools_dir;
+    std::string player_summoner_path;
+    std::string enemy_summoner_path;
+    std::string field_path;
+};
+
+/**
+ * \brief Итог одной партии.
+ */
+struct MatchResult {
+    size_t index = 0;             ///< Номер партии в пакете
+    uint64_t seed = 0;            ///< Зерно генератора партии
+    std::optional<Team> winner;   ///< Победитель или nullopt, если партия упёрлась в лимит тиков
+    size_t ticks = 0;             ///< Число сыгранных тиков
+    double seconds = 0;           ///< Время партии
+    std::string error;            ///< Сообщение об ошибке, если партия прервалась не победой
+};
+
+/**
+ * \brief Итог пакета партий.
+ */
+struct BatchReport {
+    std::vector<MatchResult> matches; ///< Итоги в порядке номеров партий
+    size_t threads = 0;               ///< Число потоков, включая вызывающий
+    double seconds = 0;               ///< Время всего пакета
+    size_t total_ticks() const;
+    double matches_per_second() const { return seconds > 0 ? matches.size() / seconds : 0; }
+    double ticks_per_second() const { return seconds > 0 ? total_ticks() / seconds : 0; }
+    size_t wins(Team team) const;
+    size_t draws() const;
+};
+
+/**
+ * \class BatchRunner
+ * \brief Прогоняет независимые партии ИИ против ИИ на планировщике задач.
+ *
+ * Каталог, поле и призыватели читаются из файлов один раз; каждая партия
+ * получает собственный объект Game на общем неизменяемом каталоге, своё зерно и лимит тиков.
+ */
+class BatchRunner {
+    public:
+        /**
+        * \brief Конструктор, загружающий каталог.
+        *
+        * \param config Пути к данным.
+        * \param threads Число потоков, включая вызывающий; 0 означает число аппаратных потоков.
+        */
+        explicit BatchRunner(const MatchConfig& config, size_t threads = 0);
+        /**
+        * \brief Прогоняет пакет партий.
+        *
+        * \param matches Число партий.
+        * \param base_seed Зерно первой партии; партия i получает base_seed + i.
+        * \param tick_limit Максимальное число тиков в партии.
+        */
+        BatchReport run(size_t matches, uint64_t base_seed, size_t tick_limit);
+        /**
+        * \brief Играет одну партию в текущем потоке.
+        */
+        MatchResult run_match(size_t index, uint64_t seed, size_t tick_limit) const;
+    private:
+        size_t threads_;
+        std::unique_ptr<Game> prototype_;
+        std::shared_ptr<const SchoolsTable> catalog_; ///< Каталог прототипа, общий для всех партий
+        std::shared_ptr<TaskScheduler> serial_; ///< Планировщик без рабочих потоков для самих партий
+};
+
+#endif
@@ -0,0 +1,131 @@
+#ifndef BINARY_FILE_HPP
+#define BINARY_FILE_HPP
+
+/**
+ * \file BinaryFile.hpp
+ * \brief Запись и чтение двоичных файлов из выровненных массивов записей.
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * \class StringTable
+ * \brief Строки файла без повторов в порядке первого появления.
+ */
+class StringTable {
+    public:
+        /**
+        * \return Номер строки в таблице.
+        */
+        uint32_t add(std::string_view string);
+        const std::vector<std::string>& strings() const { return strings_; }
+        size_t characters() const { return characters_; }
+    private:
+        std::unordered_map<std::string, uint32_t> ids_;
+        std::vector<std::string> strings_;
+        size_t characters_ = 0;
+};
+
+/**
+ * \class BinaryWriter
+ * \brief Буфер файла из массивов, каждый из которых выровнен на 8 байт.
+ */
+class BinaryWriter {
+    public:
+        static size_t aligned(size_t size) {
+            return (size + 7) & ~size_t(7);
+        }
+        template <class T>
+        void append(const T* data, size_t count) {
+            const char* bytes = reinterpret_cast<const char*>(data);
+            buffer_.insert(buffer_.end(), bytes, bytes + sizeof(T) * count);
+            buffer_.resize(aligned(buffer_.size()), 0);
+        }
+        /**
+        * \brief Дописывает смещения строк (strings + 1 число) и сами строки.
+        */
+        void append(const StringTable& strings);
+        const std::vector<char>& buffer() const { return buffer_; }
+        /**
+        * \brief Записывает буфер в файл через временный файл рядом и переименование.
+        *
+        * \param sync Сбросить данные на диск до переименования.
+        * \throw std::runtime_error Если файл не удалось записать.
+        */
+        void write(const std::string& path, bool sync = false) const {
+            write_atomically(path, buffer_.data(), buffer_.size(), sync);
+        }
+        static void write_atomically(const std::string& path, const char* data, size_t size, bool sync = false);
+    private:
+        std::vector<char> buffer_;
+};
+
+/**
+ * \class MappedFile
+ * \brief Файл, отображённый в память только для чтения.
+ */
+class MappedFile {
+    public:
+        /**
+        * \throw std::runtime_error Если файл нельзя открыть или он короче min_size.
+        */
+        MappedFile(const std::string& path, size_t min_size);
+        /**
+        * \brief Содержимое файла, собранное в памяти и не записанное на диск.
+        *
+        * \throw std::runtime_error Если буфер короче min_size.
+        */
+        MappedFile(std::vector<char> buffer, size_t min_size);
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+        ~MappedFile();
+        const char* data() const { return static_cast<const char*>(data_); }
+        size_t size() const { return size_; }
+        template <class T>
+        const T& record(size_t offset) const {
+            return *reinterpret_cast<const T*>(data() + offset);
+        }
+        /**
+        * \brief Массив записей, начинающийся с offset; offset сдвигается за него с выравниванием.
+        */
+        template <class T>
+        std::span<const T> section(size_t& offset, size_t count) const {
+            const T* begin = reinterpret_cast<const T*>(data() + offset);
+            offset += BinaryWriter::aligned(sizeof(T) * count);
+            return std::span<const T>(begin, count);
+        }
+    private:
+        void* data_ = nullptr;
+        size_t size_ = 0;
+        std::vector<char> buffer_;  ///< Содержимое, если файл не отображён
+};
+
+/**
+ * \brief Размер части файла со строками из strings строк и characters символов.
+ */
+inline size_t strings_size(size_t strings, size_t characters) {
+    return BinaryWriter::aligned(sizeof(uint32_t) * (strings + 1)) + BinaryWriter::aligned(characters);
+}
+
+/**
+ * \brief Корректны ли смещения строк: начинаются с нуля, не убывают и заканчиваются на characters.
+ */
+inline bool strings_valid(std::span<const uint32_t> offsets, size_t characters) {
+    if (offsets.empty() || offsets.front() != 0 || offsets.back() != characters) {
+        return false;
+    }
+    for (size_t i = 1; i < offsets.size(); ++i) {
+        if (offsets[i] < offsets[i - 1]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+#endif
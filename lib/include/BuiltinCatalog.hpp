@@ -0,0 +1,86 @@
+#ifndef BUILTIN_CATALOG_HPP
+#define BUILTIN_CATALOG_HPP
+
+/**
+ * \file BuiltinCatalog.hpp
+ * \brief Каталог, встроенный в программу при сборке с SUMMONERS_BUILTIN_CATALOG.
+ */
+
+#include "SchoolsTable.hpp"
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string_view>
+
+struct BuiltinUnit {
+    std::string_view name;
+    std::string_view school;
+    int max_amount;
+    double initiative;
+    double damage;
+    double entity_HP;
+    int speed;
+    double defence;
+    double xp_for_destroy;
+    bool moral;
+    double morality;
+};
+
+struct BuiltinSkill {
+    std::string_view name;
+    uint32_t unit;              ///< Номер отряда в builtin_data::units
+    UnitKind kind;
+    double min_knowledge;
+    double required_energy;
+    double knowledge_coefficient;
+};
+
+struct BuiltinSchool {
+    std::string_view name;
+    uint32_t first_skill;       ///< Начало номеров навыков в builtin_data::school_skills
+    uint32_t skills;
+    uint32_t first_dominant;    ///< Начало имён подчинённых школ в builtin_data::dominants
+    uint32_t dominants;
+};
+
+struct BuiltinKnowledge {
+    std::string_view school;
+    double knowledge;
+};
+
+struct BuiltinSummoner {
+    std::string_view file;      ///< Имя файла в data/Summoners
+    std::string_view name;
+    double initiative;
+    double damage;
+    double max_HP;
+    double accumulation_coefficient;
+    double max_energy;
+    uint32_t first_knowledge;   ///< Начало знаний в builtin_data::knowledge
+    uint32_t knowledge;
+};
+
+/**
+ * \class BuiltinCatalog
+ * \brief Доступ к constexpr-таблицам, сгенерированным catalog_codegen из data/.
+ *
+ * Таблицы вычислены при сборке, поэтому запуск не читает файлы. Матрица множителей
+ * урона в таблицах служит только для проверки отношений доминирования static_assert;
+ * урон считается по матрице SchoolsTable. Сборки для модов собираются без
+ * SUMMONERS_BUILTIN_CATALOG и загружают каталог из JSON во время работы.
+ */
+class BuiltinCatalog {
+    public:
+        /**
+        * \brief Каталог игры, построенный из встроенных таблиц один раз за процесс.
+        */
+        static std::shared_ptr<const SchoolsTable> schools_table();
+        /**
+        * \brief Встроенный призыватель по имени файла из data/Summoners.
+        *
+        * \return Дескриптор или std::nullopt, если такого файла при сборке не было.
+        */
+        static std::optional<SummonerDescriptor> summoner(std::string_view file, Team team);
+};
+
+#endif
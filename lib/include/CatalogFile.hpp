@@ -0,0 +1,178 @@
+#ifndef CATALOG_FILE_HPP
+#define CATALOG_FILE_HPP
+
+/**
+ * \file CatalogFile.hpp
+ * \brief Скомпилированный двоичный каталог школ, навыков и отрядов.
+ */
+
+#define CATALOG_VERSION 2
+#define CATALOG_FILE_NAME "Catalog.bin"
+#define CATALOG_PARSE_GRAIN 8
+
+#include "SchoolsTable.hpp"
+#include "BinaryFile.hpp"
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+class TaskScheduler;
+
+/**
+ * \brief Заголовок файла каталога.
+ *
+ * За заголовком подряд идут массивы CatalogUnit, CatalogSkill, CatalogSchool,
+ * массив ссылок (номеров навыков и строк), смещения строк и сами строки.
+ */
+struct CatalogHeader {
+    char magic[8];              ///< "SUMCAT" и два нулевых байта
+    uint32_t version;           ///< CATALOG_VERSION
+    uint32_t byte_order;        ///< 0x01020304 в порядке байтов записавшей машины
+    uint32_t units;
+    uint32_t skills;
+    uint32_t schools;
+    uint32_t links;
+    uint32_t strings;
+    uint32_t characters;
+    uint32_t errors;            ///< Число файлов, пропущенных при сборке из-за ошибок
+    uint32_t padding;
+};
+
+struct CatalogUnit {
+    uint32_t name;              ///< Номер строки
+    uint32_t school;            ///< Номер строки
+    int32_t max_amount;
+    int32_t speed;
+    double initiative;
+    double damage;
+    double entity_HP;
+    double defence;
+    double xp_for_destroy;
+    double morality;
+    uint32_t has_morality;
+    uint32_t padding;
+};
+
+struct CatalogSkill {
+    uint32_t name;              ///< Номер строки
+    uint32_t unit;              ///< Номер отряда в массиве CatalogUnit
+    uint32_t kind;              ///< UnitKind призываемого отряда
+    uint32_t padding;
+    double min_knowledge;
+    double required_energy;
+    double knowledge_coefficient;
+};
+
+struct CatalogSchool {
+    uint32_t name;              ///< Номер строки
+    uint32_t first_skill;       ///< Начало номеров навыков в массиве ссылок
+    uint32_t skills;
+    uint32_t first_dominant;    ///< Начало номеров строк подчинённых школ в массиве ссылок
+    uint32_t dominants;
+    uint32_t padding;
+};
+
+/**
+ * \brief Ошибка в одном файле каталога.
+ */
+struct CatalogError {
+    std::string file;
+    std::string message;
+};
+
+/**
+ * \brief Итог сборки каталога из JSON.
+ */
+struct CatalogReport {
+    size_t files = 0;                   ///< Число разобранных файлов, 0 если каталог взят из готового файла
+    std::vector<CatalogError> errors;   ///< Ошибки в порядке файлов, затем ошибка записи файла каталога
+    size_t threads = 0;                 ///< Число потоков разбора, включая вызывающий
+    double parse_seconds = 0;           ///< Время параллельного разбора файлов
+    double seconds = 0;                 ///< Время всей загрузки
+};
+
+/**
+ * \class CatalogFile
+ * \brief Каталог, отображённый в память через mmap.
+ *
+ * Файл собирается из JSON функцией compile (или целью catalog) и читается без
+ * разбора: записи и строки берутся прямо из отображённых страниц. Разбор JSON
+ * нужен, только если файла нет, он другой версии или какой-то исходный JSON новее.
+ */
+class CatalogFile {
+    public:
+        /**
+        * \brief Отображает файл каталога в память.
+        *
+        * \throw std::runtime_error Если файл нельзя открыть, он другой версии или повреждён.
+        */
+        explicit CatalogFile(const std::string& path);
+        /**
+        * \brief Каталог из содержимого файла, собранного в памяти.
+        *
+        * \throw std::runtime_error Если содержимое другой версии или повреждено.
+        */
+        explicit CatalogFile(std::vector<char> buffer);
+        std::span<const CatalogUnit> units() const { return units_; }
+        std::span<const CatalogSkill> skills() const { return skills_; }
+        std::span<const CatalogSchool> schools() const { return schools_; }
+        std::span<const uint32_t> links() const { return links_; }
+        std::string_view string(uint32_t index) const;
+        UnitDescriptor unit(uint32_t index) const;
+        /**
+        * \brief Строит каталог игры: школы, навыки и шаблоны всех отрядов.
+        */
+        std::shared_ptr<const SchoolsTable> schools_table() const;
+        /**
+        * \brief Собирает файл каталога из каталогов с JSON.
+        *
+        * Файлы всех трёх каталогов разбираются параллельно на scheduler (или на
+        * временном пуле, если он не передан), а затем сливаются по порядку имён,
+        * поэтому результат не зависит от числа потоков. Файл с ошибкой пропускается
+        * вместе с навыками, ссылающимися на его отряд, а ошибка попадает в отчёт.
+        *
+        * Файл сначала пишется во временный рядом и затем переименовывается, поэтому
+        * читатели никогда не видят его недописанным.
+        *
+        * \throw std::filesystem::filesystem_error Если каталога с JSON нет.
+        */
+        static CatalogReport compile(const std::string& units_dir, const std::string& skills_dir, const std::string& schools_dir, const std::string& path, TaskScheduler* scheduler = nullptr);
+        /**
+        * \brief Нужно ли пересобрать файл: его нет, версия другая, при сборке были ошибки или какой-то JSON новее.
+        */
+        static bool stale(const std::string& path, const std::string& units_dir, const std::string& skills_dir, const std::string& schools_dir);
+        /**
+        * \brief Путь к каталогу по умолчанию: CATALOG_FILE_NAME рядом с каталогом отрядов.
+        */
+        static std::string default_path(const std::string& units_dir);
+        /**
+        * \brief Загружает каталог, при необходимости пересобрав файл.
+        *
+        * Если файл каталога не удаётся записать (например, data/ только для чтения),
+        * каталог собирается в памяти, а ошибка записи попадает в отчёт.
+        *
+        * \param report Если не nullptr, сюда записываются ошибки и время загрузки.
+        */
+        static std::shared_ptr<const SchoolsTable> load(const std::string& units_dir, const std::string& skills_dir, const std::string& schools_dir, CatalogReport* report = nullptr);
+        /**
+        * \brief Разбирает JSON всех отрядов каталога параллельно.
+        *
+        * \throw std::runtime_error С именем первого файла с ошибкой.
+        */
+        static std::vector<UnitDescriptor> read_units(const std::string& units_dir);
+    private:
+        MappedFile file_;
+        std::span<const CatalogUnit> units_;
+        std::span<const CatalogSkill> skills_;
+        std::span<const CatalogSchool> schools_;
+        std::span<const uint32_t> links_;
+        std::span<const uint32_t> offsets_;
+        const char* characters_ = nullptr;
+        void open_(const std::string& name);
+        static BinaryWriter assemble_(const std::string& units_dir, const std::string& skills_dir, const std::string& schools_dir, TaskScheduler* scheduler, CatalogReport& report);
+};
+
+#endif
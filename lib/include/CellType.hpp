@@ -1,7 +1,7 @@
 #ifndef CELL_TYPE_H
 #define CELL_TYPE_H
 
-enum CellType {
+enum CellType : unsigned char {
     LAND,
     OBSTACLE
 };
@@ -0,0 +1,115 @@
+#ifndef EXPECTED_HPP
+#define EXPECTED_HPP
+
+/**
+ * \file Expected.hpp
+ * \brief Результат действия без исключений: значение или код ошибки.
+ */
+
+#include <stdexcept>
+#include <utility>
+#include <variant>
+
+/**
+ * \brief Обычные причины, по которым действие в игре не выполняется.
+ */
+enum ActionError : unsigned char {
+    CELL_UNAVIALABLE,       ///< Клетка вне поля, занята или является препятствием
+    TOO_FAR,                ///< Клетка дальше, чем можно сдвинуться за ход
+    NO_SUCH_SKILL,          ///< В школе нет навыка с таким именем
+    NOT_ENOUGH_KNOWLEDGE,   ///< Знаний школы недостаточно для навыка
+    NOT_ENOUGH_ENERGY       ///< Энергии недостаточно для навыка
+};
+
+/**
+ * \brief Текст ошибки, совпадающий с текстом исключения бросающей версии действия.
+ */
+inline const char* describe(ActionError error) {
+    switch (error) {
+        case CELL_UNAVIALABLE:
+            return "This cell is unavialable";
+        case TOO_FAR:
+            return "Your speed is not enough!";
+        case NO_SUCH_SKILL:
+            return "No such skill";
+        case NOT_ENOUGH_KNOWLEDGE:
+            return "Knowledge of this school is not enough to use this skill!";
+        default:
+            return "Your energy level is not enough to use this skill!";
+    }
+}
+
+/**
+ * \class Unexpected
+ * \brief Обёртка для ошибки при построении Expected.
+ */
+template <class E>
+class Unexpected {
+    public:
+        explicit Unexpected(E error) : error_(std::move(error)) {}
+        const E& error() const { return error_; }
+    private:
+        E error_;
+};
+
+/**
+ * \class Expected
+ * \brief Упрощённый аналог std::expected из C++23.
+ *
+ * \tparam T Тип значения; void, если действие ничего не возвращает.
+ * \tparam E Тип ошибки.
+ */
+template <class T, class E = ActionError>
+class Expected {
+    public:
+        Expected(T value) : state_(std::in_place_index<0>, std::move(value)) {}
+        Expected(Unexpected<E> unexpected) : state_(std::in_place_index<1>, unexpected.error()) {}
+        bool has_value() const { return state_.index() == 0; }
+        explicit operator bool() const { return has_value(); }
+        /**
+        * \throw std::logic_error Если результат содержит ошибку.
+        */
+        T& value() {
+            if (!has_value()) {
+                throw std::logic_error("Expected holds an error");
+            }
+            return std::get<0>(state_);
+        }
+        const T& value() const {
+            if (!has_value()) {
+                throw std::logic_error("Expected holds an error");
+            }
+            return std::get<0>(state_);
+        }
+        T value_or(T fallback) const { return has_value() ? std::get<0>(state_) : std::move(fallback); }
+        T& operator*() { return std::get<0>(state_); }
+        const T& operator*() const { return std::get<0>(state_); }
+        T* operator->() { return &std::get<0>(state_); }
+        const T* operator->() const { return &std::get<0>(state_); }
+        const E& error() const { return std::get<1>(state_); }
+    private:
+        std::variant<T, E> state_;
+};
+
+template <class E>
+class Expected<void, E> {
+    public:
+        Expected() = default;
+        Expected(Unexpected<E> unexpected) : failed_(true), error_(unexpected.error()) {}
+        bool has_value() const { return !failed_; }
+        explicit operator bool() const { return has_value(); }
+        /**
+        * \throw std::logic_error Если результат содержит ошибку.
+        */
+        void value() const {
+            if (failed_) {
+                throw std::logic_error("Expected holds an error");
+            }
+        }
+        const E& error() const { return error_; }
+    private:
+        bool failed_ = false;
+        E error_{};
+};
+
+#endif
@@ -0,0 +1,72 @@
+#ifndef FIELD_COMPONENTS_HPP
+#define FIELD_COMPONENTS_HPP
+
+/**
+ * \file FieldComponents.hpp
+ * \brief Метки компонент связности проходимых клеток поля.
+ */
+
+#include "grid.hpp"
+#include "GameCell.hpp"
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+/**
+ * \class FieldComponents
+ * \brief Компоненты связности клеток без препятствий по восьми соседям.
+ *
+ * Каждой проходимой клетке сопоставлена метка; метки одной компоненты объединены
+ * системой непересекающихся множеств, поэтому проверка связности двух клеток
+ * не зависит от размера поля.
+ *
+ * Снятие препятствия объединяет компоненты соседей клетки. Установка препятствия
+ * разрезает компоненту, только если соседи клетки не связаны друг с другом вокруг неё;
+ * тогда от каждой группы соседей одновременно запускается поиск в ширину, и новые
+ * метки получают лишь отрезанные части, а не вся компонента.
+ */
+class FieldComponents {
+    public:
+        static constexpr uint32_t none = std::numeric_limits<uint32_t>::max(); ///< Метка клетки с препятствием
+        /**
+        * \brief Размечает поле заново.
+        */
+        void build(const Grid<GameCell>& field);
+        /**
+        * \brief Обновляет метки после изменения клетки.
+        *
+        * \param field Поле, в котором клетка уже изменена.
+        * \param x Координата клетки по горизонтальной оси.
+        * \param y Координата клетки по вертикальной оси.
+        */
+        void update(const Grid<GameCell>& field, int x, int y);
+        /**
+        * \brief Номер компоненты клетки.
+        *
+        * \return Номер, общий для всех клеток компоненты, или none для препятствия и клетки вне поля.
+        */
+        uint32_t component(int x, int y) const;
+        bool connected(int x_a, int y_a, int x_b, int y_b) const {
+            uint32_t a = component(x_a, y_a);
+            return a != none && a == component(x_b, y_b);
+        }
+        /**
+        * \brief Количество компонент связности.
+        */
+        size_t count() const { return count_; }
+        bool empty() const { return labels_.empty(); }
+    private:
+        Grid<uint32_t> labels_;
+        std::vector<uint32_t> parent_;
+        std::vector<uint8_t> rank_;
+        Grid<uint32_t> marks_;
+        uint32_t mark_base_ = 0;
+        size_t count_ = 0;
+        bool in_field_(int x, int y) const { return x >= 0 && y >= 0 && static_cast<size_t>(x) < labels_.rows() && static_cast<size_t>(y) < labels_.columns(); }
+        uint32_t root_(uint32_t label) const;
+        uint32_t new_label_();
+        bool unite_(uint32_t a, uint32_t b);
+        void split_(const std::vector<uint32_t>& seeds);
+};
+
+#endif
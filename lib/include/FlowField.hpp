@@ -0,0 +1,76 @@
+#ifndef FLOW_FIELD_HPP
+#define FLOW_FIELD_HPP
+
+/**
+ * \file FlowField.hpp
+ * \brief Карта расстояний до ближайшей цели для поиска пути.
+ */
+
+#include "grid.hpp"
+#include "GameCell.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <utility>
+#include <vector>
+
+/**
+ * \class FlowField
+ * \brief Карта Дейкстры над полем: для каждой клетки число шагов до ближайшей цели.
+ *
+ * За шаг юнит переходит в любую из восьми соседних клеток, поэтому k шагов по карте
+ * никогда не превышают скорость k. Карта строится поиском в ширину сразу от всех целей
+ * и останавливается, как только достигнуты все клетки, из которых её будут читать.
+ */
+class FlowField {
+    public:
+        static constexpr uint32_t unreachable = std::numeric_limits<uint32_t>::max(); ///< Расстояние до недостижимой клетки
+        using point_t = std::pair<int, int>;
+        /**
+        * \brief Перестраивает карту.
+        *
+        * \param field Поле; препятствия непроходимы.
+        * \param targets Клетки целей.
+        * \param seekers Клетки, из которых будут искать путь; пустой список означает всё поле.
+        */
+        void build(const Grid<GameCell>& field, const std::vector<point_t>& targets, const std::vector<point_t>& seekers);
+        uint32_t distance(int x, int y) const { return distance_(x, y); }
+        bool empty() const { return distance_.empty(); }
+        /**
+        * \brief Следующая позиция на пути к ближайшей цели.
+        *
+        * Идёт не больше чем steps шагов по убыванию расстояния, пропуская клетки,
+        * для которых available ложно, и останавливается перед первой недоступной.
+        *
+        * \return Конечная клетка; совпадает с исходной, если сдвинуться нельзя.
+        */
+        template <class Available>
+        point_t step(int x, int y, int steps, Available&& available) const {
+            for (int i = 0; i < steps && in_field_(x, y); ++i) {
+                uint32_t current = distance_(x, y);
+                bool moved = false;
+                for (auto [dx, dy] : directions_) {
+                    int next_x = x + dx;
+                    int next_y = y + dy;
+                    if (in_field_(next_x, next_y) && distance_(next_x, next_y) < current && available(next_x, next_y)) {
+                        x = next_x;
+                        y = next_y;
+                        moved = true;
+                        break;
+                    }
+                }
+                if (!moved) {
+                    break;
+                }
+            }
+            return {x, y};
+        }
+    private:
+        static constexpr point_t directions_[8] = {{1, 0}, {-1, 0}, {0, 1}, {0, -1}, {1, 1}, {-1, -1}, {1, -1}, {-1, 1}};
+        Grid<uint32_t> distance_;
+        std::vector<uint32_t> frontier_;
+        std::vector<bool> wanted_;
+        bool in_field_(int x, int y) const { return x >= 0 && y >= 0 && static_cast<size_t>(x) < distance_.rows() && static_cast<size_t>(y) < distance_.columns(); }
+};
+
+#endif
@@ -0,0 +1,202 @@
+#ifndef PATH_HIERARCHY_HPP
+#define PATH_HIERARCHY_HPP
+
+/**
+ * \file PathHierarchy.hpp
+ * \brief Иерархический поиск пути по кластерам поля для очень больших карт.
+ */
+
+#include "grid.hpp"
+#include "GameCell.hpp"
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+/**
+ * \class PathHierarchy
+ * \brief Абстракция поля в духе HPA*: кластеры, графы входов и кэш путей внутри кластеров.
+ *
+ * Поле делится на квадратные кластеры. На каждой границе соседних кластеров (в том числе
+ * по диагонали через угол) выбираются входы — пары проходимых клеток по обе стороны.
+ * Поиск ведётся по графу входов, а длины путей между входами одного кластера вычисляются
+ * при первом обращении к кластеру и кэшируются до изменения препятствий в нём или рядом.
+ *
+ * Для каждой цели граф входов обходится алгоритмом Дейкстры от цели, и обход сохраняется:
+ * следующий юнит, идущий к той же клетке, продолжает его ровно настолько, насколько нужно
+ * для своего кластера, так что отряды, преследующие одного врага, ищут путь вместе.
+ *
+ * Учитываются только препятствия: клетки, занятые юнитами, проверяются при движении.
+ */
+class PathHierarchy {
+    public:
+        static constexpr uint32_t unreachable = std::numeric_limits<uint32_t>::max(); ///< Расстояние до недостижимой клетки
+        using point_t = std::pair<int, int>;
+        /**
+        * \brief Конструктор иерархии.
+        *
+        * \param cluster_size Сторона квадратного кластера в клетках.
+        */
+        explicit PathHierarchy(int cluster_size = 32);
+        PathHierarchy(const PathHierarchy&) = delete;
+        PathHierarchy& operator=(const PathHierarchy&) = delete;
+        /**
+        * \brief Помечает всё поле изменённым.
+        */
+        void invalidate() { stale_ = true; }
+        /**
+        * \brief Помечает изменённым кластер, содержащий клетку.
+        */
+        void invalidate(int x, int y);
+        /**
+        * \brief Перестраивает входы изменённых кластеров.
+        *
+        * Пути внутри кластеров не строятся сразу, а откладываются до первого запроса.
+        *
+        * \param field Поле; должно жить до следующего вызова refresh.
+        */
+        void refresh(const Grid<GameCell>& field);
+        /**
+        * \brief Путевые точки от клетки до цели.
+        *
+        * Соседние точки лежат в одном кластере или в соседних клетках на границе кластеров.
+        * Метод можно вызывать из нескольких потоков одновременно; обход от цели
+        * переиспользуется всеми запросами к ней до следующего изменения поля.
+        *
+        * \return Точки после исходной клетки, последняя из них — цель; пустой список, если цель недостижима.
+        */
+        std::vector<point_t> route(int x, int y, int goal_x, int goal_y) const;
+        /**
+        * \brief Следующая позиция на пути к цели.
+        *
+        * Идёт не больше чем steps шагов по маршруту route, пропуская клетки, для которых
+        * available ложно, и останавливается перед первой недоступной.
+        *
+        * \return Конечная клетка; совпадает с исходной, если сдвинуться нельзя.
+        */
+        template <class Available>
+        point_t step(int x, int y, int goal_x, int goal_y, int steps, Available&& available) const {
+            std::vector<uint32_t> local;
+            for (auto [waypoint_x, waypoint_y] : route(x, y, goal_x, goal_y)) {
+                bool mapped = false;
+                while (steps > 0 && (x != waypoint_x || y != waypoint_y)) {
+                    if (std::max(std::abs(x - waypoint_x), std::abs(y - waypoint_y)) == 1) {
+                        if (!available(waypoint_x, waypoint_y)) {
+                            return {x, y};
+                        }
+                        x = waypoint_x;
+                        y = waypoint_y;
+                        --steps;
+                        break;
+                    }
+                    uint32_t cluster = cluster_of_(waypoint_x, waypoint_y);
+                    if (!mapped) {
+                        local_distances_(cluster, waypoint_x, waypoint_y, local);
+                        mapped = true;
+                    }
+                    auto [top, left, bottom, right] = bounds_(cluster);
+                    if (x < top || x >= bottom || y < left || y >= right) {
+                        return {x, y};
+                    }
+                    int width = right - left;
+                    uint32_t current = local[(x - top) * width + y - left];
+                    bool moved = false;
+                    for (auto [dx, dy] : directions_) {
+                        int next_x = x + dx;
+                        int next_y = y + dy;
+                        if (next_x >= top && next_x < bottom && next_y >= left && next_y < right
+                            && local[(next_x - top) * width + next_y - left] < current && available(next_x, next_y)) {
+                            x = next_x;
+                            y = next_y;
+                            moved = true;
+                            break;
+                        }
+                    }
+                    if (!moved) {
+                        return {x, y};
+                    }
+                    --steps;
+                }
+                if (steps == 0) {
+                    break;
+                }
+            }
+            return {x, y};
+        }
+        int cluster_size() const { return cluster_size_; }
+        size_t clusters() const { return clusters_.size(); }
+        /**
+        * \brief Сколько раз строился кэш путей внутри кластеров с момента создания.
+        */
+        size_t built_clusters() const { return built_clusters_; }
+        /**
+        * \brief Число целей, обходы от которых сейчас хранятся.
+        */
+        size_t cached_goals() const;
+    private:
+        enum Side : unsigned char { SOUTH, EAST, SOUTH_EAST, SOUTH_WEST };
+        struct Transition {
+            point_t inner; ///< Клетка в кластере-владельце границы
+            point_t outer; ///< Клетка в соседнем кластере
+        };
+        struct Bounds {
+            int top;
+            int left;
+            int bottom;
+            int right;
+        };
+        struct Cluster {
+            std::vector<uint64_t> nodes;     ///< Ключи входов кластера
+            std::vector<uint32_t> distance;  ///< Длины путей между входами, nodes.size() x nodes.size()
+            std::atomic<bool> ready = false;
+        };
+        struct Record {
+            uint32_t cost;      ///< Длина пути до цели
+            uint64_t next;      ///< Следующий вход на пути к цели
+            bool settled;
+        };
+        /**
+        * \brief Незаконченный обход Дейкстры от цели по графу входов.
+        */
+        struct GoalSearch {
+            using entry_t = std::pair<uint32_t, uint64_t>;
+            std::vector<uint32_t> local;    ///< Расстояния от цели внутри её кластера
+            std::unordered_map<uint64_t, Record> records;
+            std::priority_queue<entry_t, std::vector<entry_t>, std::greater<entry_t>> open;
+            std::mutex mutex;
+        };
+        static constexpr point_t directions_[8] = {{1, 0}, {-1, 0}, {0, 1}, {0, -1}, {1, 1}, {-1, -1}, {1, -1}, {-1, 1}};
+        int cluster_size_;
+        int cluster_rows_ = 0;
+        int cluster_columns_ = 0;
+        bool stale_ = true;
+        const Grid<GameCell>* field_ = nullptr;
+        std::vector<uint32_t> dirty_;
+        std::vector<std::vector<Transition>> borders_;
+        mutable std::vector<Cluster> clusters_;
+        mutable std::mutex build_mutex_;
+        mutable size_t built_clusters_ = 0;
+        mutable std::unordered_map<uint64_t, std::shared_ptr<GoalSearch>> searches_;
+        mutable std::mutex searches_mutex_;
+        uint32_t cluster_of_(int x, int y) const { return (x / cluster_size_) * cluster_columns_ + y / cluster_size_; }
+        Bounds bounds_(uint32_t cluster) const;
+        bool passable_(int x, int y) const { return (*field_)(x, y).type() != OBSTACLE; }
+        bool neighbour_(uint32_t cluster, Side side, uint32_t& neighbour) const;
+        void build_border_(uint32_t cluster, Side side);
+        point_t cell_of_(uint64_t node) const;
+        uint32_t node_cluster_(uint64_t node) const;
+        const Cluster& cluster_(uint32_t cluster) const;
+        void local_distances_(uint32_t cluster, int x, int y, std::vector<uint32_t>& distance) const;
+        std::shared_ptr<GoalSearch> search_(int goal_x, int goal_y) const;
+        void relax_(GoalSearch& search, uint64_t node, uint32_t cost, uint64_t next) const;
+        void expand_(GoalSearch& search, uint64_t node, uint32_t cost) const;
+};
+
+#endif
@@ -0,0 +1,54 @@
+#ifndef RANDOM_STREAM_HPP
+#define RANDOM_STREAM_HPP
+
+/**
+ * \file RandomStream.hpp
+ * \brief Счётчиковый генератор псевдослучайных чисел с производными потоками.
+ */
+
+#include <cstdint>
+#include <limits>
+
+/**
+ * \class RandomStream
+ * \brief Генератор, значение которого есть хеш пары (ключ, счётчик).
+ *
+ * Состояние состоит из двух чисел, поэтому поток дёшево создавать, копировать и
+ * сохранять. Производный поток получает новый ключ из ключа родителя и номера, так
+ * что потоки для разных юнитов и тиков не зависят от порядка, в котором их запрашивают.
+ * Удовлетворяет требованиям UniformRandomBitGenerator.
+ */
+class RandomStream {
+    public:
+        using result_type = uint64_t;
+        explicit RandomStream(uint64_t key = 0, uint64_t counter = 0) : key_(key), counter_(counter) {}
+        static constexpr result_type min() { return 0; }
+        static constexpr result_type max() { return std::numeric_limits<result_type>::max(); }
+        result_type operator()() { return mix(key_ + mix(counter_++)); }
+        /**
+        * \brief Возвращает число, равномерно распределённое на [0, 1).
+        */
+        double uniform() { return ((*this)() >> 11) * 0x1.0p-53; }
+        /**
+        * \brief Производный поток с заданным номером.
+        *
+        * \param id Номер потока, например номер тика или слот юнита.
+        */
+        RandomStream substream(uint64_t id) const { return RandomStream(mix(key_ ^ mix(id + 0x632be59bd9b4e019ULL))); }
+        uint64_t key() const { return key_; }
+        uint64_t counter() const { return counter_; }
+        /**
+        * \brief Финализатор SplitMix64.
+        */
+        static constexpr uint64_t mix(uint64_t value) {
+            value += 0x9e3779b97f4a7c15ULL;
+            value = (value ^ (value >> 30)) * 0xbf58476d1ce4e5b9ULL;
+            value = (value ^ (value >> 27)) * 0x94d049bb133111ebULL;
+            return value ^ (value >> 31);
+        }
+    private:
+        uint64_t key_;
+        uint64_t counter_;
+};
+
+#endif
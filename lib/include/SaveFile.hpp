@@ -0,0 +1,127 @@
+#ifndef SAVE_FILE_HPP
+#define SAVE_FILE_HPP
+
+/**
+ * \file SaveFile.hpp
+ * \brief Двоичный снимок состояния игры.
+ */
+
+#define SAVE_VERSION 1
+#define SAVE_FILE_EXTENSION ".sav"
+
+#include "BinaryFile.hpp"
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * \brief Заголовок снимка.
+ *
+ * За заголовком подряд идут массивы SaveUnit и SaveKnowledge, смещения строк и сами строки.
+ */
+struct SaveHeader {
+    char magic[8];              ///< "SUMSAVE" и нулевой байт
+    uint32_t version;           ///< SAVE_VERSION
+    uint32_t byte_order;        ///< 0x01020304 в порядке байтов записавшей машины
+    uint64_t ticks;
+    uint64_t rng_key;           ///< Состояние RandomStream игры
+    uint64_t rng_counter;
+    double xp_to_collect;
+    int32_t winner;             ///< Team победителя или -1
+    uint32_t units;
+    uint32_t knowledge;
+    uint32_t strings;
+    uint32_t characters;
+    uint32_t padding;
+};
+
+/**
+ * \brief Юнит в порядке команд: сначала все юниты игрока, затем противника.
+ *
+ * Поля после padding заполняются только для призывателей.
+ */
+struct SaveUnit {
+    uint32_t name;              ///< Номер строки
+    uint32_t kind;              ///< UnitKind
+    uint32_t team;              ///< Team
+    int32_t x;
+    int32_t y;
+    int32_t amount;
+    double current_HP;
+    double initiative;
+    double morality;            ///< Текущая мораль, если has_morality
+    uint32_t has_morality;
+    uint32_t first_knowledge;   ///< Начало знаний призывателя в массиве SaveKnowledge
+    uint32_t knowledge;
+    uint32_t padding;
+    double damage;
+    double max_HP;
+    double accumulation_coefficient;
+    double left_XP;
+    double max_energy;
+    double current_energy;
+};
+
+struct SaveKnowledge {
+    uint32_t school;            ///< Номер строки
+    uint32_t padding;
+    double knowledge;
+};
+
+/**
+ * \brief Снимок игры в памяти: всё содержимое файла, кроме служебных полей заголовка.
+ *
+ * Состоит только из простых записей и не ссылается на юниты игры, поэтому после
+ * снятия его можно записывать из другого потока, пока игра идёт дальше.
+ */
+struct SaveSnapshot {
+    SaveHeader header{};
+    std::vector<SaveUnit> units;
+    std::vector<SaveKnowledge> knowledge;
+    StringTable strings;
+};
+
+/**
+ * \class SaveFile
+ * \brief Снимок игры, отображённый в память через mmap.
+ *
+ * Записи читаются прямо из отображённых страниц без разбора. Формат хранит всё,
+ * что меняется во время партии: здоровье, количество, инициативу и мораль отрядов,
+ * энергию, опыт и знания призывателей, номер тика и состояние генератора.
+ */
+class SaveFile {
+    public:
+        /**
+        * \brief Отображает снимок в память.
+        *
+        * \throw std::runtime_error Если файл нельзя открыть, он другой версии или повреждён.
+        */
+        explicit SaveFile(const std::string& path);
+        const SaveHeader& header() const { return *header_; }
+        std::span<const SaveUnit> units() const { return units_; }
+        std::span<const SaveKnowledge> knowledge() const { return knowledge_; }
+        std::string_view string(uint32_t index) const;
+        /**
+        * \brief Записывает снимок через временный файл и переименование.
+        *
+        * Поля magic, version, byte_order и размеры массивов заголовка заполняются здесь.
+        *
+        * \param sync Сбросить данные на диск до переименования.
+        */
+        static void write(const std::string& path, const SaveSnapshot& snapshot, bool sync = false);
+        /**
+        * \brief Является ли файл двоичным снимком (а не сохранением в JSON).
+        */
+        static bool is_snapshot(const std::string& path);
+    private:
+        MappedFile file_;
+        const SaveHeader* header_ = nullptr;
+        std::span<const SaveUnit> units_;
+        std::span<const SaveKnowledge> knowledge_;
+        std::span<const uint32_t> offsets_;
+        const char* characters_ = nullptr;
+};
+
+#endif
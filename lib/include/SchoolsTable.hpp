@@ -1,15 +1,60 @@
 #ifndef SCHOOLSTABLE_HPP
 #define SCHOOLSTABLE_HPP
 
+#define DOMINANT_COEFFICIENT 1.2
+#define SUBMISSIVE_COEFFICIENT 0.8
+
 #include "school.hpp"
+#include "Expected.hpp"
+#include <limits>
+#include <vector>
+
+/**
+ * \brief Навык школы в порядке возрастания требуемой энергии.
+ */
+struct RankedSkill {
+    double required_energy;
+    double min_knowledge;
+    double damage;
+    uint32_t skill;     ///< Номер навыка в School::skills
+    uint32_t best;      ///< Позиция самого сильного навыка среди этого и более дешёвых
+};
 
+/**
+ * \class SchoolsTable
+ * \brief Каталог школ, навыков и шаблонов отрядов.
+ *
+ * Константные методы ничего не меняют, поэтому один каталог, загруженный заранее
+ * и обёрнутый в std::shared_ptr<const SchoolsTable>, могут одновременно читать
+ * сколько угодно игр. Быстрые индексы (матрица множителей, индекс и упорядочение
+ * навыков) строятся refresh_catalog; пока каталог изменён и не перестроен,
+ * константные поиски идут медленным путём по самим школам.
+ */
 class SchoolsTable {
     private:
-        std::unordered_map<std::string, School> table_;
+        static constexpr uint32_t no_school_ = std::numeric_limits<uint32_t>::max();
+        std::unordered_map<Symbol, School> table_;
+        std::unordered_map<Symbol, UnitTemplate> units_;   ///< Все отряды каталога, в том числе не призываемые навыками
+        std::vector<uint32_t> school_index_;    ///< Номер школы в матрице по идентификатору символа
+        std::vector<double> coefficients_;      ///< Множители урона, schools_amount() x schools_amount()
+        std::unordered_map<uint64_t, uint32_t> skill_index_;    ///< Номер навыка в School::skills по паре (школа, навык)
+        std::unordered_map<Symbol, std::vector<RankedSkill>> ranking_;
+        bool catalog_stale_ = true;
+        void build_catalog_();
+        static uint64_t skill_key_(Symbol school_name, Symbol skill_name) {
+            return static_cast<uint64_t>(school_name.id()) << 32 | skill_name.id();
+        }
     public:
         SchoolsTable() = default;
-        SchoolsTable(std::unordered_map<std::string, School>& table) : table_(table) {}
+        /**
+        * \brief Конструктор из таблицы, прочитанной по именам; ключи заменяются символами.
+        */
+        SchoolsTable(std::unordered_map<std::string, School>& table) : table_(table.begin(), table.end()) {}
+        /**
+        * \brief Изменяемая таблица; индексы каталога будут перестроены при следующем обращении.
+        */
         auto& table() {
+            catalog_stale_ = true;
             return table_;
         }
         const auto& table() const {
@@ -17,14 +62,84 @@ class SchoolsTable {
         }
         void add_school(const School& school);
         void add_skill(const Skill& skill);
-        Skill& get_skill(const std::string& school_name, const std::string& skill_name);
-        School& get_school(const std::string& name);
+        /**
+        * \brief Добавляет отряд в каталог; навыки с такими же характеристиками разделят его шаблон.
+        */
+        void add_unit(const UnitDescriptor& unit);
+        /**
+        * \brief Шаблон отряда по имени.
+        *
+        * \return Шаблон или пустой шаблон, если отряда нет.
+        */
+        UnitTemplate find_unit(Symbol name) const;
+        size_t units_amount() const { return units_.size(); }
+        /**
+        * \brief Изменяемый навык; индексы каталога будут перестроены при следующем обращении.
+        *
+        * \throw std::invalid_argument Если навыка нет.
+        */
+        Skill& get_skill(Symbol school_name, Symbol skill_name);
+        const Skill& get_skill(Symbol school_name, Symbol skill_name) const;
+        /**
+        * \brief Поиск навыка без исключений; в отличие от get_school не добавляет неизвестную школу.
+        *
+        * Изменяемая версия, как и get_skill, помечает индексы каталога устаревшими.
+        *
+        * \return Указатель на навык или NO_SUCH_SKILL.
+        */
+        Expected<Skill*> find_skill(Symbol school_name, Symbol skill_name);
+        Expected<const Skill*> find_skill(Symbol school_name, Symbol skill_name) const;
+        /**
+        * \brief Изменяемая школа по имени; неизвестная школа добавляется пустой.
+        */
+        School& get_school(Symbol name);
+        /**
+        * \brief Школа по имени без изменения таблицы.
+        *
+        * \throw std::invalid_argument Если школы нет.
+        */
+        const School& get_school(Symbol name) const;
+        /**
+        * \return Указатель на школу или nullptr.
+        */
+        const School* find_school(Symbol name) const;
+        /**
+        * \brief Множитель урона юнита школы attacker по юниту школы defender.
+        *
+        * Берётся из плотной матрицы, построенной по отношениям доминирования один раз после
+        * загрузки. Для неизвестных школ и призывателей (пустой символ) равен 1.0.
+        */
+        double coefficient(Symbol attacker, Symbol defender) const;
+        /**
+        * \brief Самый сильный навык школы, доступный при данных энергии и знаниях.
+        *
+        * Навыки школы заранее упорядочены по требуемой энергии, и для каждого префикса
+        * запомнен навык с наибольшим уроном, поэтому выбор — двоичный поиск по энергии.
+        * Перебор префикса нужен, только если лучшему навыку не хватает знаний.
+        *
+        * \return Указатель на навык, действительный до изменения каталога, или nullptr.
+        */
+        const Skill* best_skill(Symbol school_name, double energy, double knowledge) const;
+        /**
+        * \brief Перестраивает индексы каталога, если он изменялся.
+        */
+        void refresh_catalog() {
+            if (catalog_stale_) {
+                build_catalog_();
+            }
+        }
+        bool catalog_stale() const { return catalog_stale_; }
         size_t skills_amount() const;
         size_t schools_amount() const;
-        auto begin() { return table_.begin(); }
-        auto cbegin() { return table_.cbegin(); }
-        auto end() { return table_.end(); }
-        auto cend() { return table_.cend(); }
+        /**
+        * \brief Изменяемый обход школ; индексы каталога будут перестроены при следующем обращении.
+        */
+        auto begin() { catalog_stale_ = true; return table_.begin(); }
+        auto begin() const { return table_.begin(); }
+        auto cbegin() const { return table_.cbegin(); }
+        auto end() { catalog_stale_ = true; return table_.end(); }
+        auto end() const { return table_.end(); }
+        auto cend() const { return table_.cend(); }
 };
 
 #endif
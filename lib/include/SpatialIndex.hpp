@@ -0,0 +1,91 @@
+#ifndef SPATIAL_INDEX_HPP
+#define SPATIAL_INDEX_HPP
+
+/**
+ * \file SpatialIndex.hpp
+ * \brief Пространственный индекс юнитов одной команды.
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <vector>
+
+/**
+ * \class SpatialIndex
+ * \brief Равномерная сетка корзин над полем, хранящая позиции юнитов.
+ *
+ * Юниты задаются номерами слотов в хранилище UnitStore.
+ *
+ * Поиск ближайшего юнита обходит кольца корзин вокруг точки запроса и
+ * останавливается, как только следующее кольцо заведомо дальше найденного.
+ */
+class SpatialIndex {
+    public:
+        static constexpr uint32_t npos = std::numeric_limits<uint32_t>::max(); ///< Отсутствие юнита
+        struct Entry {
+            uint32_t unit;  ///< Слот юнита
+            int x;          ///< Координата по горизонтальной оси
+            int y;          ///< Координата по вертикальной оси
+        };
+        /**
+        * \brief Конструктор индекса.
+        *
+        * \param width Ширина поля.
+        * \param height Высота поля.
+        * \param bucket_size Сторона квадратной корзины в клетках.
+        */
+        SpatialIndex(int width = 0, int height = 0, int bucket_size = 8);
+        void insert(uint32_t unit, int x, int y);
+        void erase(uint32_t unit, int x, int y);
+        void move(uint32_t unit, int from_x, int from_y, int to_x, int to_y);
+        void clear();
+        size_t size() const { return size_; }
+        bool empty() const { return size_ == 0; }
+        /**
+        * \brief Ближайший к точке юнит.
+        *
+        * \return Слот юнита или npos, если индекс пуст.
+        */
+        uint32_t nearest(int x, int y) const;
+        /**
+        * \brief Ближайший к точке юнит, для слота которого accept истинно.
+        *
+        * \return Слот юнита или npos, если подходящих юнитов нет.
+        */
+        uint32_t nearest_if(int x, int y, const std::function<bool(uint32_t)>& accept) const;
+        /**
+        * \brief До k ближайших к точке юнитов в порядке возрастания расстояния.
+        */
+        std::vector<uint32_t> k_nearest(int x, int y, size_t k) const;
+        /**
+        * \brief Все юниты на евклидовом расстоянии не больше radius от точки.
+        */
+        std::vector<uint32_t> within_radius(int x, int y, int radius) const;
+        /**
+        * \brief Подбирает сторону корзины так, чтобы число корзин на большом поле оставалось ограниченным.
+        */
+        static int bucket_size_for(int width, int height);
+        static int64_t distance2(int x_a, int y_a, int x_b, int y_b) {
+            int64_t dx = x_a - x_b;
+            int64_t dy = y_a - y_b;
+            return dx * dx + dy * dy;
+        }
+    private:
+        int bucket_size_;
+        int columns_;
+        int rows_;
+        size_t size_ = 0;
+        std::vector<std::vector<Entry>> buckets_;
+        int column_of_(int x) const;
+        int row_of_(int y) const;
+        std::vector<Entry>& bucket_(int x, int y) { return buckets_[row_of_(y) * columns_ + column_of_(x)]; }
+        int64_t ring_bound_(int ring) const { int64_t bound = static_cast<int64_t>(ring) * bucket_size_ + 1; return bound * bound; }
+        template <class F>
+        void for_each_in_ring_(int column, int row, int ring, F&& f) const;
+        template <class Accept>
+        uint32_t nearest_(int x, int y, Accept&& accept) const;
+};
+
+#endif
@@ -0,0 +1,60 @@
+#ifndef SYMBOL_HPP
+#define SYMBOL_HPP
+
+/**
+ * \file Symbol.hpp
+ * \brief Интернированные имена школ, навыков и юнитов.
+ */
+
+#include <compare>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <ostream>
+#include <string>
+#include <string_view>
+
+/**
+ * \class Symbol
+ * \brief Имя, заменённое плотным целочисленным идентификатором.
+ *
+ * Каждая различная строка получает номер при первом появлении, обычно при загрузке
+ * каталога из JSON. Дальше символы копируются, сравниваются и хешируются как числа,
+ * а к строке обращаются только на границе ввода-вывода (JSON, GameView, GameManager).
+ *
+ * Таблица имён общая для процесса и только растёт, поэтому идентификатор одного
+ * и того же имени одинаков во всех играх. Регистрация и чтение имён потокобезопасны.
+ */
+class Symbol {
+    public:
+        /**
+        * \brief Пустое имя с идентификатором 0.
+        */
+        Symbol() = default;
+        Symbol(std::string_view name);
+        Symbol(const std::string& name) : Symbol(std::string_view(name)) {}
+        Symbol(const char* name) : Symbol(std::string_view(name)) {}
+        uint32_t id() const { return id_; }
+        bool empty() const { return id_ == 0; }
+        /**
+        * \brief Строка, соответствующая символу; ссылка действительна до конца работы программы.
+        */
+        const std::string& name() const;
+        operator const std::string&() const { return name(); }
+        friend bool operator==(Symbol one, Symbol two) { return one.id_ == two.id_; }
+        friend std::strong_ordering operator<=>(Symbol one, Symbol two) { return one.id_ <=> two.id_; }
+        friend std::ostream& operator<<(std::ostream& out, Symbol symbol) { return out << symbol.name(); }
+        /**
+        * \brief Количество зарегистрированных имён, включая пустое.
+        */
+        static size_t count();
+    private:
+        uint32_t id_ = 0;
+};
+
+template <>
+struct std::hash<Symbol> {
+    size_t operator()(Symbol symbol) const noexcept { return symbol.id(); }
+};
+
+#endif
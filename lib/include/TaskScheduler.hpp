@@ -0,0 +1,114 @@
+#ifndef TASK_SCHEDULER_HPP
+#define TASK_SCHEDULER_HPP
+
+/**
+ * \file TaskScheduler.hpp
+ * \brief Постоянный пул потоков с перехватом задач.
+ */
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * \class TaskScheduler
+ * \brief Пул рабочих потоков, каждый со своей очередью; простаивающий поток забирает задачи из чужих очередей.
+ *
+ * Потоки создаются один раз. Поток, вызвавший parallel_for, сам выполняет задачи,
+ * пока ждёт, поэтому вложенные вызовы не блокируют пул. Диапазоны не длиннее
+ * порога последовательного выполнения обрабатываются на месте без постановки задач.
+ */
+class TaskScheduler {
+    public:
+        /**
+        * \brief Число рабочих потоков по умолчанию: все аппаратные потоки, кроме вызывающего.
+        */
+        static size_t default_workers();
+        /**
+        * \brief Конструктор планировщика.
+        *
+        * \param workers Число рабочих потоков; при 0 всё выполняется в вызывающем потоке.
+        * \param serial_cutoff Длина диапазона, до которой parallel_for не распараллеливается.
+        */
+        explicit TaskScheduler(size_t workers = default_workers(), size_t serial_cutoff = 256);
+        TaskScheduler(const TaskScheduler&) = delete;
+        TaskScheduler& operator=(const TaskScheduler&) = delete;
+        ~TaskScheduler();
+        size_t workers() const { return threads_.size(); }
+        size_t serial_cutoff() const { return serial_cutoff_; }
+        void set_serial_cutoff(size_t serial_cutoff) { serial_cutoff_ = serial_cutoff; }
+        /**
+        * \brief Вызывает body(first, last) для кусков диапазона [begin, end) длиной не больше grain.
+        *
+        * Возвращается после обработки всего диапазона. Первое исключение из body
+        * пробрасывается вызывающему.
+        *
+        * \param begin Начало диапазона.
+        * \param end Конец диапазона.
+        * \param grain Наибольшая длина куска.
+        * \param body Функция от границ куска.
+        */
+        template <class F>
+        void parallel_for(size_t begin, size_t end, size_t grain, F&& body) {
+            if (end <= begin) {
+                return;
+            }
+            grain = grain == 0 ? 1 : grain;
+            if (threads_.empty() || end - begin <= serial_cutoff_ || end - begin <= grain) {
+                body(begin, end);
+                return;
+            }
+            std::atomic<size_t> remaining = (end - begin + grain - 1) / grain;
+            std::exception_ptr error;
+            std::mutex error_mutex;
+            size_t queue = home_();
+            for (size_t first = begin; first < end; first += grain) {
+                size_t last = std::min(first + grain, end);
+                push_(queue, [&, first, last](){
+                    try {
+                        body(first, last);
+                    }
+                    catch (...) {
+                        std::lock_guard lock(error_mutex);
+                        if (error == nullptr) {
+                            error = std::current_exception();
+                        }
+                    }
+                    remaining.fetch_sub(1, std::memory_order_acq_rel);
+                });
+                queue = (queue + 1) % queues_.size();
+            }
+            while (remaining.load(std::memory_order_acquire) != 0) {
+                if (!run_one_(home_())) {
+                    std::this_thread::yield();
+                }
+            }
+            if (error != nullptr) {
+                std::rethrow_exception(error);
+            }
+        }
+    private:
+        struct Queue {
+            std::mutex mutex;
+            std::deque<std::function<void()>> tasks;
+        };
+        std::vector<std::unique_ptr<Queue>> queues_; ///< Очереди рабочих потоков и общая очередь внешних потоков
+        std::vector<std::thread> threads_;
+        std::atomic<size_t> pending_ = 0;
+        std::atomic<bool> stopping_ = false;
+        std::mutex sleep_mutex_;
+        std::condition_variable wake_;
+        size_t serial_cutoff_;
+        size_t home_() const;
+        void push_(size_t queue, std::function<void()> task);
+        bool run_one_(size_t home);
+        void work_(size_t index);
+};
+
+#endif
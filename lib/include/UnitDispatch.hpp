@@ -0,0 +1,107 @@
+#ifndef UNIT_DISPATCH_HPP
+#define UNIT_DISPATCH_HPP
+
+/**
+ * \file UnitDispatch.hpp
+ * \brief Статическая диспетчеризация по закрытому набору видов юнитов.
+ */
+
+#include "units.hpp"
+#include <type_traits>
+
+/**
+ * \class UnitDispatch
+ * \brief Вызов методов юнита по его виду без обращения к таблице виртуальных функций.
+ *
+ * Вид юнита хранится в самом юните и в слоте UnitStore, поэтому конкретный тип
+ * выбирается одним switch, а метод вызывается квалифицированно и может быть встроен.
+ */
+class UnitDispatch {
+    public:
+        /**
+        * \brief Вызывает f со ссылкой на юнит, приведённой к его конкретному типу.
+        *
+        * \param unit Юнит.
+        * \param f Обобщённая функция от MoralUnit&, AmoralUnit&, RessurectionUnit&, Kamikaze& и Summoner&.
+        * \return Результат f.
+        */
+        template <class F>
+        static decltype(auto) visit(BaseUnit& unit, F&& f) {
+            switch (unit.kind()) {
+                case MORAL:
+                    return f(static_cast<MoralUnit&>(unit));
+                case AMORAL:
+                    return f(static_cast<AmoralUnit&>(unit));
+                case RESSURECTION:
+                    return f(static_cast<RessurectionUnit&>(unit));
+                case KAMIKAZE:
+                    return f(static_cast<Kamikaze&>(unit));
+                default:
+                    return f(static_cast<Summoner&>(unit));
+            }
+        }
+        static void make_turn(BaseUnit& unit, Game& game, Team self_team) {
+            visit(unit, [&](auto& concrete) {
+                using T = std::remove_cvref_t<decltype(concrete)>;
+                concrete.T::make_turn(game, self_team);
+            });
+        }
+        /**
+        * \brief Намерение юнита на тик; для камикадзе и призывателей возвращает Intent::SERIAL.
+        */
+        static Intent plan_turn(BaseUnit& unit, Game& game, Team self_team) {
+            return visit(unit, [&](auto& concrete) -> Intent {
+                using T = std::remove_cvref_t<decltype(concrete)>;
+                if constexpr (std::is_same_v<T, Kamikaze> || std::is_same_v<T, Summoner>) {
+                    return Intent{};
+                } else {
+                    return concrete.T::plan_turn(game, self_team);
+                }
+            });
+        }
+        static void apply_turn(BaseUnit& unit, Game& game, Team self_team, const Intent& intent) {
+            if (intent.action == Intent::SERIAL) {
+                make_turn(unit, game, self_team);
+                return;
+            }
+            visit(unit, [&](auto& concrete) {
+                using T = std::remove_cvref_t<decltype(concrete)>;
+                if constexpr (std::is_same_v<T, Kamikaze> || std::is_same_v<T, Summoner>) {
+                    concrete.T::make_turn(game, self_team);
+                } else {
+                    concrete.T::apply_turn(game, self_team, intent);
+                }
+            });
+        }
+        static void take_damage(BaseUnit& unit, double damage) {
+            visit(unit, [&](auto& concrete) {
+                using T = std::remove_cvref_t<decltype(concrete)>;
+                concrete.T::take_damage(damage);
+            });
+        }
+        static void make_damage(BaseUnit& unit, Game& game, BaseUnit::unit_t enemy) {
+            visit(unit, [&](auto& concrete) {
+                using T = std::remove_cvref_t<decltype(concrete)>;
+                concrete.T::make_damage(game, std::move(enemy));
+            });
+        }
+        /**
+        * \brief Имя вида юнита в формате сохранений и описаний навыков.
+        */
+        static const char* kind_name(UnitKind kind) {
+            switch (kind) {
+                case MORAL:
+                    return "Moral";
+                case AMORAL:
+                    return "Amoral";
+                case RESSURECTION:
+                    return "Ressurection";
+                case KAMIKAZE:
+                    return "Kamikaze";
+                default:
+                    return "Summoner";
+            }
+        }
+};
+
+#endif
@@ -0,0 +1,83 @@
+#ifndef UNIT_POOL_HPP
+#define UNIT_POOL_HPP
+
+/**
+ * \file UnitPool.hpp
+ * \brief Пул памяти для объектов юнитов.
+ */
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+/**
+ * \class UnitPool
+ * \brief Слябовый пул блоков фиксированного размера.
+ *
+ * Блоки группируются по классам размеров, кратным max_align_t. Освобождённые
+ * блоки попадают во встроенный список свободных и переиспользуются, так что
+ * после прогрева пул не обращается к общей куче. Пул не потокобезопасен:
+ * у каждой игры свой пул.
+ */
+class UnitPool {
+    public:
+        static constexpr size_t alignment = alignof(std::max_align_t); ///< Выравнивание блоков
+        static constexpr size_t blocks_per_slab = 64; ///< Число блоков в одном сляб
+        UnitPool() = default;
+        UnitPool(const UnitPool&) = delete;
+        UnitPool& operator=(const UnitPool&) = delete;
+        ~UnitPool();
+        /**
+        * \brief Выделяет блок не меньше заданного размера.
+        */
+        void* allocate(size_t bytes);
+        /**
+        * \brief Возвращает блок в пул.
+        */
+        void deallocate(void* block, size_t bytes) noexcept;
+        /**
+        * \brief Общее число выделенных блоков.
+        */
+        size_t allocations() const { return allocations_; }
+        /**
+        * \brief Число обращений к общей куче за новыми слябами.
+        */
+        size_t heap_allocations() const { return slabs_.size(); }
+        /**
+        * \brief Число блоков, занятых в данный момент.
+        */
+        size_t in_use() const { return in_use_; }
+    private:
+        struct FreeBlock {
+            FreeBlock* next;
+        };
+        std::vector<FreeBlock*> free_; ///< Списки свободных блоков по классам размеров
+        std::vector<void*> slabs_;
+        size_t allocations_ = 0;
+        size_t in_use_ = 0;
+        static size_t size_class_(size_t bytes) { return (bytes + alignment - 1) / alignment; }
+        void grow_(size_t size_class);
+};
+
+/**
+ * \brief Аллокатор, берущий память из UnitPool, для std::allocate_shared.
+ *
+ * Хранит владеющий указатель на пул, поэтому пул живёт, пока жив хотя бы один юнит из него.
+ */
+template <class T>
+struct PoolAllocator {
+    using value_type = T;
+    std::shared_ptr<UnitPool> pool;
+    PoolAllocator(std::shared_ptr<UnitPool> unit_pool) noexcept : pool(std::move(unit_pool)) {}
+    template <class U>
+    PoolAllocator(const PoolAllocator<U>& other) noexcept : pool(other.pool) {}
+    T* allocate(size_t n) {
+        static_assert(alignof(T) <= UnitPool::alignment, "Over-aligned types are not supported by UnitPool");
+        return static_cast<T*>(pool->allocate(n * sizeof(T)));
+    }
+    void deallocate(T* block, size_t n) noexcept { pool->deallocate(block, n * sizeof(T)); }
+    template <class U>
+    bool operator==(const PoolAllocator<U>& other) const noexcept { return pool == other.pool; }
+};
+
+#endif
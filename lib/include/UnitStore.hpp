@@ -0,0 +1,68 @@
+#ifndef UNIT_STORE_HPP
+#define UNIT_STORE_HPP
+
+/**
+ * \file UnitStore.hpp
+ * \brief Хранилище горячего состояния юнитов в виде структуры массивов.
+ */
+
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "descriptors.hpp"
+
+class BaseUnit;
+
+/**
+ * \class UnitStore
+ * \brief Состояние развёрнутых на поле юнитов, разложенное по непрерывным массивам.
+ *
+ * Каждый развёрнутый юнит занимает слот, одинаковый во всех массивах. Объекты
+ * BaseUnit, привязанные к слоту, читают и пишут своё состояние прямо сюда, так что
+ * проходы по всем юнитам в тике идут по плотным данным без обращения к объектам.
+ * Освобождённые слоты переиспользуются.
+ */
+class UnitStore {
+    public:
+        static constexpr uint32_t no_slot = std::numeric_limits<uint32_t>::max(); ///< Отсутствие слота
+        std::vector<int> x;              ///< Координаты по горизонтальной оси
+        std::vector<int> y;              ///< Координаты по вертикальной оси
+        std::vector<double> hp;          ///< Текущее здоровье
+        std::vector<int> amount;         ///< Текущее количество существ в отряде
+        std::vector<double> initiative;  ///< Инициатива
+        std::vector<Team> team;          ///< Команда
+        std::vector<Symbol> school;      ///< Школа
+        std::vector<UnitKind> kind;      ///< Конкретный вид юнита
+        std::vector<BaseUnit*> owner;    ///< Юнит, занимающий слот, или nullptr для свободного слота
+        /**
+        * \brief Выделяет слот под юнит.
+        *
+        * \param unit Юнит, который будет занимать слот.
+        * \param unit_team Команда юнита.
+        * \param unit_school Школа юнита.
+        * \param unit_kind Вид юнита.
+        * \return Номер слота.
+        */
+        uint32_t acquire(BaseUnit* unit, Team unit_team, Symbol unit_school, UnitKind unit_kind);
+        /**
+        * \brief Освобождает слот для повторного использования.
+        */
+        void release(uint32_t slot);
+        const std::string& school_name(Symbol school) const { return school.name(); }
+        /**
+        * \brief Возвращает число слотов, включая свободные.
+        */
+        size_t slots() const { return owner.size(); }
+        /**
+        * \brief Возвращает число занятых слотов.
+        */
+        size_t live() const { return owner.size() - free_.size(); }
+        bool alive(uint32_t slot) const { return owner[slot] != nullptr && hp[slot] > 0; }
+        void clear();
+    private:
+        std::vector<uint32_t> free_;
+};
+
+#endif
@@ -4,6 +4,8 @@
 #define MAX_MORALITY 1.0
 #define MIN_MORALITY -1.0
 
+#include "Symbol.hpp"
+#include <memory>
 #include <string>
 #include <optional>
 #include <unordered_map>
@@ -13,9 +15,17 @@ enum Team {
     ENEMY
 };
 
+enum UnitKind : unsigned char {
+    MORAL,
+    AMORAL,
+    RESSURECTION,
+    KAMIKAZE,
+    SUMMONER
+};
+
 struct SummonerDescriptor {
     Team team;
-    std::string name;
+    Symbol name;
     double initiative;
     double damage;
     double max_HP;
@@ -24,13 +34,13 @@ struct SummonerDescriptor {
     double left_XP;
     double max_energy;
     double current_energy;
-    std::unordered_map<std::string, double> schools_knowledge;
-    SummonerDescriptor(Team init_team, std::string init_name, double init_initiative, double init_damage, double init_max_HP, double init_accumulation_coefficient, double init_max_energy, const std::unordered_map<std::string, double>& init_schools_knowledge) : team(init_team), name(init_name), initiative(init_initiative), damage(init_damage), max_HP(init_max_HP), current_HP(init_max_HP), accumulation_coefficient(init_accumulation_coefficient), left_XP(0), max_energy(init_max_energy), current_energy(init_max_energy), schools_knowledge(init_schools_knowledge) {}
+    std::unordered_map<Symbol, double> schools_knowledge;
+    SummonerDescriptor(Team init_team, const std::string& init_name, double init_initiative, double init_damage, double init_max_HP, double init_accumulation_coefficient, double init_max_energy, const std::unordered_map<Symbol, double>& init_schools_knowledge) : team(init_team), name(init_name), initiative(init_initiative), damage(init_damage), max_HP(init_max_HP), current_HP(init_max_HP), accumulation_coefficient(init_accumulation_coefficient), left_XP(0), max_energy(init_max_energy), current_energy(init_max_energy), schools_knowledge(init_schools_knowledge) {}
 };
 
 struct UnitDescriptor {
-    std::string name;
-    std::string school;
+    Symbol name;
+    Symbol school;
     int max_amount;
     int amount;
     double initiative;
@@ -41,9 +51,32 @@ struct UnitDescriptor {
     double defence;
     double xp_for_destroy;
     std::optional<double> morality;
-    UnitDescriptor(std::string init_name, std::string init_school, double init_initiative, int init_max_amount, double init_damage, double init_entity_HP, int init_speed, double init_defence, double init_xp_for_destroy, std::optional<double> init_morality) : name(init_name), school(init_school), initiative(init_initiative), max_amount(init_max_amount), amount(init_max_amount), damage(init_damage), entity_HP(init_entity_HP), current_HP(init_entity_HP * init_max_amount), speed(init_speed), defence(init_defence), xp_for_destroy(init_xp_for_destroy), morality(init_morality) {}
+    UnitDescriptor(const std::string& init_name, const std::string& init_school, double init_initiative, int init_max_amount, double init_damage, double init_entity_HP, int init_speed, double init_defence, double init_xp_for_destroy, std::optional<double> init_morality) : name(init_name), school(init_school), initiative(init_initiative), max_amount(init_max_amount), amount(init_max_amount), damage(init_damage), entity_HP(init_entity_HP), current_HP(init_entity_HP * init_max_amount), speed(init_speed), defence(init_defence), xp_for_destroy(init_xp_for_destroy), morality(init_morality) {}
     UnitDescriptor() = default;
+    bool operator==(const UnitDescriptor&) const = default;
+};
 
+/**
+ * \class UnitTemplate
+ * \brief Общий неизменяемый дескриптор для всех отрядов одного вида.
+ *
+ * Отряды хранят только указатель на шаблон и своё изменяемое состояние
+ * (здоровье, количество, инициативу, мораль), а имена, школа и боевые
+ * характеристики лежат в одном экземпляре, принадлежащем каталогу навыков.
+ */
+class UnitTemplate {
+    public:
+        UnitTemplate() = default;
+        /**
+        * \brief Новый шаблон, скопированный из дескриптора.
+        */
+        UnitTemplate(const UnitDescriptor& descriptor) : descriptor_(std::make_shared<const UnitDescriptor>(descriptor)) {}
+        const UnitDescriptor& operator*() const { return *descriptor_; }
+        const UnitDescriptor* operator->() const { return descriptor_.get(); }
+        const UnitDescriptor* get() const { return descriptor_.get(); }
+        explicit operator bool() const { return descriptor_ != nullptr; }
+    private:
+        std::shared_ptr<const UnitDescriptor> descriptor_;
 };
 
 #endif
@@ -2,26 +2,56 @@
 #define FACTORY_HPP
 
 #include "units.hpp"
+#include "UnitPool.hpp"
+#include <functional>
+#include <stdexcept>
 
 class Factory {
     public:
-        static std::shared_ptr<MoralUnit> create_moral_unit(UnitDescriptor& descriptor) {
-            return std::make_shared<MoralUnit>(0, 0, descriptor); 
+        using creator_t = std::function<std::shared_ptr<BaseUnit>(const UnitTemplate&, const std::shared_ptr<UnitPool>&)>;
+        template <class T, class... Args>
+        static std::shared_ptr<T> create(const std::shared_ptr<UnitPool>& pool, Args&&... args) {
+            if (pool == nullptr) {
+                return std::make_shared<T>(std::forward<Args>(args)...);
+            }
+            return std::allocate_shared<T>(PoolAllocator<T>(pool), std::forward<Args>(args)...);
+        }
+        static std::shared_ptr<MoralUnit> create_moral_unit(const UnitTemplate& unit_template, const std::shared_ptr<UnitPool>& pool = nullptr) {
+            return create<MoralUnit>(pool, 0, 0, unit_template);
         }
-        static std::shared_ptr<AmoralUnit> create_amoral_unit(UnitDescriptor& descriptor) {
-            return std::make_shared<AmoralUnit>(0, 0, descriptor);
+        static std::shared_ptr<AmoralUnit> create_amoral_unit(const UnitTemplate& unit_template, const std::shared_ptr<UnitPool>& pool = nullptr) {
+            return create<AmoralUnit>(pool, 0, 0, unit_template);
         }
-        static std::shared_ptr<RessurectionUnit> create_ressurection_unit(UnitDescriptor& descriptor) {
-            auto entity = std::make_shared<RessurectionUnit>(0, 0, descriptor);
-            if (descriptor.morality == std::nullopt) {
-                entity->unit() = std::make_shared<AmoralUnit>(0, 0, descriptor);
+        static std::shared_ptr<RessurectionUnit> create_ressurection_unit(const UnitTemplate& unit_template, const std::shared_ptr<UnitPool>& pool = nullptr) {
+            std::shared_ptr<RealUnit> unit;
+            if (unit_template->morality == std::nullopt) {
+                unit = create<AmoralUnit>(pool, 0, 0, unit_template);
             } else {
-                entity->unit() = std::make_shared<MoralUnit>(0, 0, descriptor);
+                unit = create<MoralUnit>(pool, 0, 0, unit_template);
             }
-            return entity;
+            return create<RessurectionUnit>(pool, 0, 0, unit_template, std::move(unit));
         }   
-        static std::shared_ptr<Kamikaze> create_kamikaze(UnitDescriptor& descriptor) {
-            return std::make_shared<Kamikaze>(0, 0, descriptor);
+        static std::shared_ptr<Kamikaze> create_kamikaze(const UnitTemplate& unit_template, const std::shared_ptr<UnitPool>& pool = nullptr) {
+            return create<Kamikaze>(pool, 0, 0, unit_template);
+        }
+        /**
+        * \brief Функция создания отряда данного вида для навыка.
+        *
+        * \throw std::invalid_argument Для призывателя.
+        */
+        static creator_t creator(UnitKind kind) {
+            switch (kind) {
+                case MORAL:
+                    return create_moral_unit;
+                case AMORAL:
+                    return create_amoral_unit;
+                case RESSURECTION:
+                    return create_ressurection_unit;
+                case KAMIKAZE:
+                    return create_kamikaze;
+                default:
+                    throw std::invalid_argument("Summoners can't be summoned");
+            }
         }
 };
 
@@ -1,57 +1,244 @@
 #ifndef GAME_HPP
 #define GAME_HPP
 
-#define FIELD_WEIGHT 40
-#define FIELD_HEIGHT 40
+#define DEFAULT_FIELD_WIDTH 40
+#define DEFAULT_FIELD_HEIGHT 40
+#define PATH_HIERARCHY_MIN_CELLS (256 * 256)
 
 #include "SchoolsTable.hpp"
+#include "CatalogFile.hpp"
+#include "Autosaver.hpp"
 #include "matrix.hpp"
+#include "grid.hpp"
 #include "GameCell.hpp"
+#include "UnitStore.hpp"
+#include "UnitPool.hpp"
+#include "RandomStream.hpp"
+#include "TaskScheduler.hpp"
+#include "SpatialIndex.hpp"
+#include "FlowField.hpp"
+#include "PathHierarchy.hpp"
+#include "FieldComponents.hpp"
 #include "GameView.hpp"
 #include "GameManager.hpp"
+#include <cstdint>
+#include <optional>
+#include <random>
+
+enum TickMode {
+    SEQUENTIAL,
+    TWO_PHASE
+};
 
 class Game {
+    public:
+        using units_t = std::vector<std::shared_ptr<BaseUnit>>;
     private:
         bool is_active_ = true;
+        bool interactive_ = true;
+        std::optional<Team> winner_;
+        size_t ticks_ = 0;
+        RandomStream rng_{std::random_device{}()};
         GameManager manager_;
         GameView view_;
-        using units_t = std::vector<std::shared_ptr<BaseUnit>>;
         units_t player_units_;
         units_t enemy_units_;
-        Matrix<GameCell, FIELD_WEIGHT, FIELD_HEIGHT> field_;
-        SchoolsTable schools_table_;
+        std::vector<uint32_t> player_slots_;
+        std::vector<uint32_t> enemy_slots_;
+        std::vector<std::pair<uint32_t, Team>> turn_order_;
+        std::vector<Intent> intents_;
+        TickMode tick_mode_ = SEQUENTIAL;
+        UnitStore store_;
+        std::shared_ptr<UnitPool> pool_ = std::make_shared<UnitPool>();
+        std::shared_ptr<TaskScheduler> scheduler_;
+        std::shared_ptr<Autosaver> autosaver_;
+        CatalogReport catalog_report_;
+        size_t last_tick_allocations_ = 0;
+        size_t last_tick_heap_allocations_ = 0;
+        Grid<GameCell> field_;
+        Grid<uint32_t> occupancy_;
+        SpatialIndex player_index_;
+        SpatialIndex enemy_index_;
+        FlowField player_paths_;
+        FlowField enemy_paths_;
+        PathHierarchy hierarchy_;
+        FieldComponents components_;
+        bool components_stale_ = false;
+        std::vector<uint32_t> player_components_;   ///< Компоненты связности с юнитами игрока, по возрастанию
+        std::vector<uint32_t> enemy_components_;
+        bool occupied_stale_ = true;                ///< Списки выше устарели после изменения поля
+        size_t player_paths_tick_ = std::numeric_limits<size_t>::max();
+        size_t enemy_paths_tick_ = std::numeric_limits<size_t>::max();
+        std::shared_ptr<const SchoolsTable> schools_table_;
+        std::shared_ptr<SchoolsTable> own_schools_table_; ///< Собственная копия каталога после edit_schools_table
         double xp_to_collect_ = 0;
-        SchoolsTable read_schools_table_(const std::string& units_dir, const std::string& skills_dir, const std::string& schools_dir);
         std::shared_ptr<Summoner> read_summoner_(const std::string& summoner_path, Team team);
-        Matrix<GameCell, FIELD_WEIGHT, FIELD_HEIGHT> read_field_(const std::string& field_path);
+        UnitTemplate find_template_(const std::string& name, const std::string& units_dir, std::unordered_map<std::string, UnitTemplate>& loaded) const;
+        Grid<GameCell> read_field_(const std::string& field_path);
+        void reset_layers_();
+        void refresh_components_();
+        void refresh_occupied_();
+        void occupy_(uint32_t slot);
+        void track_(BaseUnit* unit, Team team);
+        void untrack_(BaseUnit& unit);
+        void sort_by_initiative_(units_t& units, std::vector<uint32_t>& slots);
+        void erase_dead_(units_t& units, std::vector<uint32_t>& slots);
+        SpatialIndex& index_(Team team) { return team == PLAYER ? player_index_ : enemy_index_; }
+        const SpatialIndex& index_(Team team) const { return team == PLAYER ? player_index_ : enemy_index_; }
+        std::vector<uint32_t>& slots_(Team team) { return team == PLAYER ? player_slots_ : enemy_slots_; }
+        const FlowField& paths_(Team team) const { return team == PLAYER ? player_paths_ : enemy_paths_; }
+        const std::vector<uint32_t>& occupied_(Team team) const { return team == PLAYER ? player_components_ : enemy_components_; }
+        bool hierarchical_() const { return field_.size() > PATH_HIERARCHY_MIN_CELLS; }
+        std::shared_ptr<BaseUnit> share_(uint32_t slot) { return slot == UnitStore::no_slot ? nullptr : store_.owner[slot]->shared_from_this(); }
     public:
         Game(const std::string& units_dir, const std::string& skills_dir, const std::string& schools_dir, const std::string& player_summoner_path, const std::string& enemy_summoner_path, const std::string& field_path);
         Game(const std::string& units_dir, const std::string& skills_dir, const std::string& schools_dir, const std::string& player_summoner_path, const std::string& enemy_summoner_path, const std::string& field_path, const std::string& save_path);
-        Game(SchoolsTable& schools_table, Matrix<GameCell, FIELD_WEIGHT, FIELD_HEIGHT>& field) {
-            schools_table_ = schools_table;
+        Game(SchoolsTable& schools_table, const Grid<GameCell>& field) {
+            own_schools_table_ = std::make_shared<SchoolsTable>(schools_table);
+            own_schools_table_->refresh_catalog();
+            schools_table_ = own_schools_table_;
+            field_ = field;
+            reset_layers_();
+        }
+        /**
+        * \brief Игра на общем каталоге без его копирования.
+        *
+        * \param schools_table Каталог, загруженный read_schools_table и разделяемый между играми.
+        * \param field Игровое поле.
+        */
+        Game(std::shared_ptr<const SchoolsTable> schools_table, const Grid<GameCell>& field) : schools_table_(std::move(schools_table)) {
             field_ = field;
+            reset_layers_();
         }
-        Game(units_t& p_units, units_t& e_units, SchoolsTable& schools_table, Matrix<GameCell, FIELD_WEIGHT, FIELD_HEIGHT>& field) {
+        Game(units_t& p_units, units_t& e_units, SchoolsTable& schools_table, const Grid<GameCell>& field) {
             player_units_ = p_units;
             enemy_units_ = e_units;
-            schools_table_ = schools_table;
+            own_schools_table_ = std::make_shared<SchoolsTable>(schools_table);
+            own_schools_table_->refresh_catalog();
+            schools_table_ = own_schools_table_;
             field_ = field;
+            reset_layers_();
         }
+        Game(const Game&) = delete;
+        Game& operator=(const Game&) = delete;
+        ~Game();
         bool& is_active() { return is_active_; }
+        bool& interactive() { return interactive_; }
+        TickMode& tick_mode() { return tick_mode_; }
+        const std::optional<Team>& winner() const { return winner_; }
+        size_t ticks() const { return ticks_; }
+        void seed(uint64_t seed) { rng_ = RandomStream(seed); }
+        RandomStream& rng() { return rng_; }
+        RandomStream stream(uint32_t slot) const { return rng_.substream(ticks_).substream(slot); }
+        /**
+        * \brief Экспорт расстановки в JSON: вид, имя, здоровье и позиция юнитов, опыт призывателей.
+        */
         void write_save(const std::string& save_path);
         void read_save(const std::string& save_path, const std::string& units_dir);
-        SchoolsTable& schools_table() { return schools_table_; }
+        /**
+        * \brief Записывает полный двоичный снимок игры (SaveFile) через временный файл и переименование.
+        *
+        * \param sync Сбросить снимок на диск до переименования.
+        */
+        void write_snapshot(const std::string& path, bool sync = false);
+        /**
+        * \brief Снимает состояние игры в простые записи для SaveFile.
+        *
+        * Стоит одного прохода по юнитам без обращений к диску.
+        */
+        SaveSnapshot take_snapshot();
+        /**
+        * \brief Восстанавливает игру из двоичного снимка.
+        *
+        * Игра должна быть только что создана: призыватели снимка заменяют её призывателей
+        * (или размещаются, если их нет), остальные отряды добавляются.
+        *
+        * \throw std::runtime_error Если снимок повреждён или другой версии.
+        */
+        void read_snapshot(const std::string& path, const std::string& units_dir);
+        /**
+        * \brief Загружает каталог школ, навыков и отрядов один раз для любого числа игр.
+        *
+        * При сборке с SUMMONERS_BUILTIN_CATALOG каталоги не читаются: возвращается
+        * каталог, встроенный в программу (BuiltinCatalog).
+        *
+        * \param report Если не nullptr, сюда записываются пропущенные файлы с ошибками и время загрузки.
+        * \return Каталог с построенными индексами, который можно читать из нескольких потоков.
+        */
+        static std::shared_ptr<const SchoolsTable> read_schools_table(const std::string& units_dir, const std::string& skills_dir, const std::string& schools_dir, CatalogReport* report = nullptr);
+        /**
+        * \brief Итог загрузки каталога конструктором из файлов.
+        */
+        const CatalogReport& catalog_report() const { return catalog_report_; }
+        const SchoolsTable& schools_table() const { return *schools_table_; }
+        /**
+        * \brief Каталог игры для передачи другим играм.
+        */
+        std::shared_ptr<const SchoolsTable> catalog();
+        /**
+        * \brief Изменяемый каталог этой игры.
+        *
+        * Если каталог разделён с другими играми, игра сначала получает собственную копию,
+        * так что правки не видны остальным.
+        */
+        SchoolsTable& edit_schools_table();
         void add_xp(double xp) { xp_to_collect_ += xp; }
         double get_xp() { double tmp = xp_to_collect_; xp_to_collect_ = 0; return tmp; }
         void game_start();
         void game_over(Team winner_team);
         void deploy_unit(int x, int y, std::shared_ptr<BaseUnit> unit, Team team);
+        /**
+        * \brief Размещение юнита без исключений.
+        *
+        * \return Пустой результат или CELL_UNAVIALABLE.
+        */
+        Expected<void> try_deploy(int x, int y, std::shared_ptr<BaseUnit> unit, Team team);
+        void move_unit(BaseUnit& unit, int x, int y);
+        /**
+        * \brief Перестановка юнита без исключений и без проверки дальности хода.
+        *
+        * \return Пустой результат или CELL_UNAVIALABLE.
+        */
+        Expected<void> try_move_unit(BaseUnit& unit, int x, int y);
         void remove_unit(std::shared_ptr<BaseUnit> unit);
         void remove_dead();
         std::shared_ptr<BaseUnit> find_closest_enemy(int x, int y, Team team);
-        bool is_avialable(int x, int y);
-        Matrix<GameCell, FIELD_WEIGHT, FIELD_HEIGHT>& field() { return field_; }
-        const Matrix<GameCell, FIELD_WEIGHT, FIELD_HEIGHT>& field() const { return field_; }
+        uint32_t closest_enemy_slot(int x, int y, Team team) const;
+        /**
+        * \brief Связаны ли клетки путём по клеткам без препятствий.
+        *
+        * Пока разметка устарела после изменения поля через edit_field(), считает клетки связанными.
+        */
+        bool reachable(int x_a, int y_a, int x_b, int y_b) const { return components_stale_ || components_.connected(x_a, y_a, x_b, y_b); }
+        const FieldComponents& components() const { return components_; }
+        void update_paths(Team team);
+        std::pair<int, int> path_step(int x, int y, Team team, int steps) const;
+        units_t find_closest_enemies(int x, int y, Team team, size_t k);
+        units_t find_enemies_within(int x, int y, Team team, int radius);
+        int field_width() const { return static_cast<int>(field_.rows()); }
+        int field_height() const { return static_cast<int>(field_.columns()); }
+        bool in_field(int x, int y) const { return x >= 0 && y >= 0 && x < field_width() && y < field_height(); }
+        bool is_avialable(int x, int y) const;
+        BaseUnit* unit_at(int x, int y) const { return in_field(x, y) && occupancy_(x, y) != UnitStore::no_slot ? store_.owner[occupancy_(x, y)] : nullptr; }
+        const UnitStore& store() const { return store_; }
+        const std::shared_ptr<UnitPool>& unit_pool() const { return pool_; }
+        TaskScheduler& scheduler();
+        void set_scheduler(std::shared_ptr<TaskScheduler> scheduler) { scheduler_ = std::move(scheduler); }
+        /**
+        * \brief Включает автосохранение: после каждого подходящего тика снимок уходит автосохранителю.
+        *
+        * \param autosaver Автосохранитель или nullptr, чтобы выключить.
+        */
+        void set_autosaver(std::shared_ptr<Autosaver> autosaver) { autosaver_ = std::move(autosaver); }
+        const std::shared_ptr<Autosaver>& autosaver() const { return autosaver_; }
+        size_t last_tick_allocations() const { return last_tick_allocations_; }
+        size_t last_tick_heap_allocations() const { return last_tick_heap_allocations_; }
+        /**
+        * \brief Изменяемое поле: сбрасывает потоки путей, иерархию и разметку связности.
+        */
+        Grid<GameCell>& edit_field() { player_paths_tick_ = enemy_paths_tick_ = std::numeric_limits<size_t>::max(); hierarchy_.invalidate(); components_stale_ = occupied_stale_ = true; return field_; }
+        void set_cell(int x, int y, GameCell cell);
+        const Grid<GameCell>& field() const { return field_; }
         const units_t& teammates() const { return player_units_; }
         const units_t& enemies() const { return enemy_units_; }
         units_t& teammates() { return player_units_; }
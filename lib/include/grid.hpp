@@ -0,0 +1,205 @@
+#ifndef GRID_HPP
+#define GRID_HPP
+
+#include "MatrixIterators.hpp"
+#include "matrix.hpp"
+#include <algorithm>
+#include <stdexcept>
+
+/**
+ * \file grid.hpp
+ * \brief Реализация шаблонного класса матрицы, размер которой задаётся во время выполнения.
+ */
+
+/**
+ * \class Grid
+ * \brief Матрица с размерами, известными только во время выполнения.
+ *
+ * В отличие от Matrix, элементы хранятся в куче, поэтому объекты Grid
+ * подходят для больших полей и не занимают места на стеке.
+ *
+ * \tparam T Тип элементов, хранящихся в матрице.
+ */
+template <class T>
+class Grid {
+    public:
+        /** \brief Типы данных для элементов и итераторов матрицы. */
+        using value_type = T;                ///< Тип элементов в матрице
+        using pointer = T*;                  ///< Указатель на элементы в матрице
+        using const_pointer = const T*;      ///< Константный указатель на элементы в матрице
+        using reference = T&;                ///< Ссылка на элемент в матрице
+        using const_reference = const T&;    ///< Константная ссылка на элемент в матрице
+        using difference_type = ptrdiff_t;   ///< Тип разности для итераторов
+        using size_type = size_t;            ///< Тип для операций с размерам.
+        using iterator = MatrixIterator<value_type, false>; ///< Изменяемый итератор
+        using const_iterator = MatrixIterator<value_type, true>; ///< Константный итератор
+        using rows_iterator = iterator;      ///< Итератор по строкам (изменяемый)
+        using rows_const_iterator = const_iterator; ///< Итератор по строкам (константный)
+        using columns_iterator = MatrixColumnIterator<value_type, false>; ///< Итератор по столбцам (изменяемый)
+        using columns_const_iterator = MatrixColumnIterator<value_type, true>; ///< Итератор по столбцам (константный).
+        /**
+        * \brief Конструктор пустой матрицы.
+        */
+        Grid() noexcept = default;
+        /**
+        * \brief Конструктор матрицы заданного размера.
+        * \param rows Количество строк.
+        * \param columns Количество столбцов.
+        */
+        Grid(size_t rows, size_t columns) : rows_(rows), columns_(columns), grid_(std::make_unique<T[]>(rows * columns)) {}
+        /**
+        * \brief Конструктор матрицы заданного размера, заполненной значением.
+        * \param rows Количество строк.
+        * \param columns Количество столбцов.
+        * \param val Значение для заполнения.
+        */
+        Grid(size_t rows, size_t columns, const value_type& val) : Grid(rows, columns) { fill(val); }
+        /**
+        * \brief Конструктор из матрицы фиксированного размера.
+        * \param matrix Матрица, из которой выполняется копирование.
+        */
+        template <const size_t M, const size_t N>
+        Grid(const Matrix<T, M, N>& matrix) requires std::copy_constructible<T> : Grid(M, N) { std::copy(matrix.cbegin(), matrix.cend(), begin()); }
+        /**
+        * \brief Конструктор копирования.
+        * \param other Матрица, из которой выполняется копирование.
+        */
+        Grid(const Grid& other) requires std::copy_constructible<T> : Grid(other.rows_, other.columns_) { std::copy(other.cbegin(), other.cend(), begin()); }
+        /**
+        * \brief Конструктор перемещения.
+        * \param moved Матрица, из которой выполняется перемещение.
+        */
+        Grid(Grid&& moved) noexcept { swap(moved); }
+        /**
+        * \brief Оператор присваивания (копирование).
+        * \param other Матрица, из которой выполняется копирование.
+        * \return Ссылка на текущую матрицу.
+        */
+        Grid& operator=(const Grid& other) requires std::copy_constructible<T> {
+            if (this != &other) {
+                Grid copy(other);
+                swap(copy);
+            }
+            return *this;
+        }
+        /**
+        * \brief Оператор присваивания (перемещение).
+        * \param moved Матрица, из которой выполняется перемещение.
+        * \return Ссылка на текущую матрицу.
+        */
+        Grid& operator=(Grid&& moved) noexcept {
+            if (this != &moved) {
+                swap(moved);
+            }
+            return *this;
+        }
+        /**
+        * \brief Заполняет матрицу заданным значением.
+        * \param val Значение для заполнения матрицы.
+        */
+        void fill(const value_type& val) { std::fill_n(begin(), size(), val); }
+        /**
+        * \brief Возвращает количество строк.
+        */
+        size_type rows() const noexcept { return rows_; }
+        /**
+        * \brief Возвращает количество столбцов.
+        */
+        size_type columns() const noexcept { return columns_; }
+        /**
+        * \brief Возвращает общий размер матрицы.
+        * \return Количество элементов в матрице.
+        */
+        size_type size() const noexcept { return rows_ * columns_; }
+        /**
+        * \brief Проверяет, пуста ли матрица.
+        * \return true, если матрица пуста, иначе false.
+        */
+        bool empty() const noexcept { return size() == 0; }
+        /**
+        * \brief Меняет содержимое текущей матрицы с другой.
+        * \param other Матрица для обмена данными.
+        */
+        void swap(Grid& other) noexcept {
+            std::swap(rows_, other.rows_);
+            std::swap(columns_, other.columns_);
+            std::swap(grid_, other.grid_);
+        }
+        /**
+        * \brief Доступ к элементу по строке и столбцу с проверкой границ.
+        * \param i Индекс строки.
+        * \param j Индекс столбца.
+        * \return Ссылка на элемент в указанной позиции.
+        * \throw std::out_of_range Если индексы выходят за границы.
+        */
+        reference at(size_t i, size_t j) {
+            if (i >= rows_ || j >= columns_) {
+                throw std::out_of_range("No such element!");
+            }
+            return grid_[columns_ * i + j];
+        }
+        /**
+        * \brief Доступ к элементу по строке и столбцу с проверкой границ (константная версия).
+        * \param i Индекс строки.
+        * \param j Индекс столбца.
+        * \return Константная ссылка на элемент в указанной позиции.
+        * \throw std::out_of_range Если индексы выходят за границы.
+        */
+        const_reference at(size_t i, size_t j) const {
+            if (i >= rows_ || j >= columns_) {
+                throw std::out_of_range("No such element!");
+            }
+            return grid_[columns_ * i + j];
+        }
+        /**
+        * \brief Доступ к элементу без проверки границ.
+        * \param i Индекс строки.
+        * \param j Индекс столбца.
+        * \return Ссылка на элемент в указанной позиции.
+        */
+        reference operator()(size_t i, size_t j) noexcept { return grid_[columns_ * i + j]; }
+        /**
+        * \brief Доступ к элементу без проверки границ (константная версия).
+        * \param i Индекс строки.
+        * \param j Индекс столбца.
+        * \return Константная ссылка на элемент в указанной позиции.
+        */
+        const_reference operator()(size_t i, size_t j) const noexcept { return grid_[columns_ * i + j]; }
+        /**
+        * \brief Проверка равенства двух матриц.
+        * \param one Первая матрица.
+        * \param two Вторая матрица.
+        * \return true, если размеры и элементы матриц совпадают, иначе false.
+        */
+        friend bool operator==(const Grid<T>& one, const Grid<T>& two) {
+            return one.rows_ == two.rows_ && one.columns_ == two.columns_ && std::equal(one.cbegin(), one.cend(), two.cbegin());
+        }
+        /**
+        * \brief Возвращает указатель на внутренние данные матрицы.
+        * \return Указатель на первый элемент.
+        */
+        pointer data() { return grid_.get(); }
+        /**
+        * \brief Возвращает константный указатель на внутренние данные матрицы.
+        * \return Константный указатель на первый элемент.
+        */
+        const_pointer data() const { return grid_.get(); }
+        iterator begin() noexcept { return iterator(grid_.get()); }
+        iterator end() noexcept { return iterator(grid_.get() + size()); }
+        const_iterator cbegin() const noexcept { return const_iterator(grid_.get()); }
+        const_iterator cend() const noexcept { return const_iterator(grid_.get() + size()); }
+        rows_iterator row_begin(size_t row) noexcept { return rows_iterator(grid_.get() + row * columns_); }
+        rows_iterator row_end(size_t row) noexcept { return rows_iterator(grid_.get() + (row + 1) * columns_); }
+        rows_const_iterator row_cbegin(size_t row) const noexcept { return rows_const_iterator(grid_.get() + row * columns_); }
+        rows_const_iterator row_cend(size_t row) const noexcept { return rows_const_iterator(grid_.get() + (row + 1) * columns_); }
+        columns_iterator column_begin(size_t column) noexcept { return columns_iterator(grid_.get() + column, columns_); }
+        columns_iterator column_end(size_t column) noexcept { return columns_iterator(grid_.get() + column + size(), columns_); }
+        columns_const_iterator column_cbegin(size_t column) const noexcept { return columns_const_iterator(grid_.get() + column, columns_); }
+        columns_const_iterator column_cend(size_t column) const noexcept { return columns_const_iterator(grid_.get() + column + size(), columns_); }
+    private:
+        size_t rows_ = 0;    ///< Количество строк.
+        size_t columns_ = 0; ///< Количество столбцов.
+        std::unique_ptr<T[]> grid_; ///< Внутренний массив для хранения элементов матрицы.
+};
+
+#endif
@@ -2,17 +2,19 @@
 #define SKILL_H
 
 #include "units.hpp"
+#include "UnitPool.hpp"
 #include <functional>
 
 struct Skill {
         UnitDescriptor characteristics;
-        std::function<std::shared_ptr<BaseUnit>(UnitDescriptor&)> create;
-        std::string name;
+        UnitTemplate unit;      ///< Шаблон призываемых отрядов; SchoolsTable обновляет его по characteristics
+        std::function<std::shared_ptr<BaseUnit>(const UnitTemplate&, const std::shared_ptr<UnitPool>&)> create;
+        Symbol name;
         double min_knowledge;
         double required_energy;
         double knowledge_coefficient;
         Skill() = default;
-        Skill(UnitDescriptor ud, std::function<std::shared_ptr<BaseUnit>(UnitDescriptor&)> f, std::string n, double mk, double nrg, double coef) : characteristics(ud), create(f), name(n), min_knowledge(mk), required_energy(nrg), knowledge_coefficient(coef) {}
+        Skill(UnitDescriptor ud, std::function<std::shared_ptr<BaseUnit>(const UnitTemplate&, const std::shared_ptr<UnitPool>&)> f, const std::string& n, double mk, double nrg, double coef) : characteristics(ud), unit(characteristics), create(f), name(n), min_knowledge(mk), required_energy(nrg), knowledge_coefficient(coef) {}
 };
 
 #endif
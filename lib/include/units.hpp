@@ -6,20 +6,42 @@
  * \brief Реализация существующих в игре отрядов.
  */
 
+#include <limits>
 #include <memory>
 #include <random>
 #include "descriptors.hpp"
+#include "UnitStore.hpp"
+#include "Expected.hpp"
 
 class SchoolsTable;
 class Game;
 
+/**
+ * \brief Намерение юнита на тик, вычисленное по состоянию на начало тика.
+ */
+struct Intent {
+    enum Action : unsigned char {
+        SERIAL, ///< Юнит не планирует ход заранее и ходит обычным make_turn
+        IDLE,   ///< Юнит пропускает ход
+        MOVE,   ///< Юнит идёт в клетку (x, y)
+        ATTACK  ///< Юнит атакует юнита в слоте target
+    };
+    Action action = SERIAL;
+    int x = 0;
+    int y = 0;
+    uint32_t target = UnitStore::no_slot;
+};
+
 /**
  * @brief Реализация базового юнита.
  */
-class BaseUnit {
+class BaseUnit : public std::enable_shared_from_this<BaseUnit> {
     private:
         int x_ = 0; ///< Координата по горизонтальной оси
         int y_ = 0; ///< Координата по вертикальной оси
+        UnitStore* store_ = nullptr; ///< Хранилище, к слоту которого привязан юнит
+        uint32_t slot_ = UnitStore::no_slot; ///< Слот юнита в хранилище
+        UnitKind kind_; ///< Конкретный вид юнита
     public:
         using unit_t = std::shared_ptr<BaseUnit>;
         /**
@@ -27,15 +49,24 @@ class BaseUnit {
         *
         * \param x Координата по горизонтальной оси
         * \param y Координата по вертикальной оси
+        * \param kind Конкретный вид юнита
         */
-        BaseUnit(int x, int y) : x_(x), y_(y) {}
+        BaseUnit(int x, int y, UnitKind kind) : x_(x), y_(y), kind_(kind) {}
+        /**
+        * \brief Возвращает конкретный вид юнита.
+        *
+        * Набор видов закрыт, поэтому по нему можно выбрать реализацию без виртуального вызова (см. UnitDispatch).
+        */
+        UnitKind kind() const {
+            return kind_;
+        }
         /**
         * \brief Возвращает текущую позицию юнита по X.
         * 
         * \return Позиция юнита по X.
         */
         virtual int& x() {
-            return x_;
+            return store_ != nullptr ? store_->x[slot_] : x_;
         }
         /**
         * \brief Возвращает текущую позицию юнита по Y.
@@ -43,9 +74,37 @@ class BaseUnit {
         * \return Позиция юнита по Y.
         */
         virtual int& y() {
-            return y_;
+            return store_ != nullptr ? store_->y[slot_] : y_;
         }
         /**
+        * \brief Возвращает хранилище, к которому привязан юнит.
+        *
+        * \return Указатель на хранилище или nullptr, если юнит не развёрнут на поле.
+        */
+        UnitStore* store() const {
+            return store_;
+        }
+        /**
+        * \brief Возвращает слот юнита в хранилище.
+        */
+        uint32_t slot() const {
+            return slot_;
+        }
+        /**
+        * \brief Привязывает юнит к слоту хранилища.
+        *
+        * Текущее состояние юнита копируется в слот, после чего все обращения к
+        * координатам, здоровью, количеству и инициативе идут в хранилище.
+        *
+        * \param store Хранилище.
+        * \param slot Слот юнита.
+        */
+        virtual void bind(UnitStore* store, uint32_t slot);
+        /**
+        * \brief Отвязывает юнит от хранилища, возвращая состояние из слота в сам юнит.
+        */
+        virtual void unbind();
+        /**
         * \brief Обработка смерти юнита.
         * 
         * \param game Текущий объект игры.
@@ -64,7 +123,7 @@ class BaseUnit {
         * \param enemy Указатель на вражеский юнит.
         * \return Коэффициент урона.
         */
-        virtual double damage_coefficient(SchoolsTable& table, unit_t enemy) = 0;
+        virtual double damage_coefficient(const SchoolsTable& table, unit_t enemy) = 0;
         /**
         * \brief Возвращает имя юнита.
         * 
@@ -72,6 +131,12 @@ class BaseUnit {
         */
         virtual const std::string& name() = 0;
         /**
+        * \brief Возвращает школу юнита.
+        * 
+        * \return Символ школы; пустой для призывателя.
+        */
+        virtual Symbol school() = 0;
+        /**
         * \brief Возвращает текущее здоровье юнита.
         * 
         * \return Текущее здоровье юнита.
@@ -82,7 +147,7 @@ class BaseUnit {
         * 
         * \return Текущее количество существ.
         */
-        virtual int amount() = 0;
+        virtual int& amount() = 0;
         /**
         * \brief Возвращает инициативу юнита.
         * 
@@ -118,6 +183,12 @@ class BaseUnit {
         */
         virtual void move(Game& game, int x, int y) = 0;
         /**
+        * \brief Перемещение юнита без исключений.
+        *
+        * \return Пустой результат или TOO_FAR, CELL_UNAVIALABLE.
+        */
+        virtual Expected<void> try_move(Game& game, int x, int y) = 0;
+        /**
         * @brief Выполнение действий в текущем ходе.
         * 
         * @param game Текущий объект игры.
@@ -129,39 +200,71 @@ class BaseUnit {
 
 /**
  * @brief Общий базовый класс для отрядов, не являющихся призывателями.
+ *
+ * Неизменяемые характеристики берутся из общего шаблона. На 64-битной сборке объект
+ * занимает 88 байт: 48 байт BaseUnit, 16 байт указателя на шаблон и 24 байта здоровья,
+ * инициативы и количества, которые используются, пока юнит не привязан к хранилищу.
  */
 class RealUnit : public BaseUnit {
     private:
-        UnitDescriptor characteristics_; ///< Дескриптор с характеристиками отряда
+        UnitTemplate template_; ///< Общий для отрядов этого вида дескриптор
+        double current_HP_;     ///< Здоровье, пока юнит не привязан к хранилищу
+        double initiative_;     ///< Инициатива, пока юнит не привязан к хранилищу
+        int amount_;            ///< Количество, пока юнит не привязан к хранилищу
     public:
         /**
         * \brief Конструктор общего базового класса не-призывателя.
         * 
         * \param x Координата по горизонтальной оси.
         * \param y Координата по вертикальной оси.
-        * \param descriptor Дескриптор с характеристиками юнита.
+        * \param unit_template Шаблон с характеристиками юнита.
+        * \param kind Конкретный вид юнита.
         */
-        RealUnit(int x, int y, UnitDescriptor& descriptor) : BaseUnit(x, y), characteristics_(descriptor) {}
-        virtual UnitDescriptor& characteristics() {
-        return characteristics_;
+        RealUnit(int x, int y, const UnitTemplate& unit_template, UnitKind kind) : BaseUnit(x, y, kind), template_(unit_template), current_HP_(unit_template->current_HP), initiative_(unit_template->initiative), amount_(unit_template->amount) {}
+        /**
+        * \brief Неизменяемые характеристики вида отряда.
+        *
+        * Текущие здоровье, количество и инициатива берутся из current_HP, amount и initiative.
+        */
+        const UnitDescriptor& characteristics() const {
+            return *template_;
+        }
+        const UnitTemplate& unit_template() const {
+            return template_;
         }
         const std::string& name() override {
             return characteristics().name;
         }
+        Symbol school() override {
+            return characteristics().school;
+        }
         double damage() override {
             return characteristics().damage;    
         }
         double& initiative() override {
-            return characteristics().initiative;
+            return store() != nullptr ? store()->initiative[slot()] : initiative_;
         }
         double& current_HP() override {
-            return characteristics().current_HP;
+            return store() != nullptr ? store()->hp[slot()] : current_HP_;
         }
-        int amount() override {
-            return characteristics().amount;
+        int& amount() override {
+            return store() != nullptr ? store()->amount[slot()] : amount_;
         }
         void make_turn(Game&, Team self_team) override;
+        /**
+        * \brief Вычисляет намерение на тик, только читая состояние игры.
+        *
+        * Безопасно вызывать одновременно для разных юнитов.
+        */
+        Intent plan_turn(Game& game, Team self_team);
+        /**
+        * \brief Выполняет намерение, вычисленное plan_turn.
+        *
+        * Если цель уже погибла или клетка занята, юнит ходит обычным make_turn по текущему состоянию.
+        */
+        void apply_turn(Game& game, Team self_team, const Intent& intent);
         void move(Game& game, int x, int y) override;
+        Expected<void> try_move(Game& game, int x, int y) override;
         void make_damage(Game& game, unit_t enemy) override;
         void take_damage(double damage) override;
         double xp_for_destroy() override { return characteristics().xp_for_destroy; }
@@ -169,22 +272,30 @@ class RealUnit : public BaseUnit {
         * \brief Обновляет количество активных юнитов на основе их текущего здоровья.
         */
         virtual void update_amount();
-        double damage_coefficient(SchoolsTable& table, unit_t enemy) override;
+        double damage_coefficient(const SchoolsTable& table, unit_t enemy) override;
 };
 
 /**
  * @brief Класс юнита с механикой морали.
  */
 class MoralUnit : public RealUnit {
+    private:
+        double morality_; ///< Текущая мораль отряда
     public:
         /**
         * \brief Конструктор морального юнита.
         * 
         * \param x Координата по горизонтальной оси.
         * \param y Координата по вертикальной оси.
-        * \param descriptor Дескриптор с характеристиками юнита.
+        * \param unit_template Шаблон с характеристиками юнита.
         */
-        MoralUnit(int x, int y, UnitDescriptor& descriptor) : RealUnit(x, y, descriptor) {}
+        MoralUnit(int x, int y, const UnitTemplate& unit_template) : RealUnit(x, y, unit_template, MORAL), morality_(unit_template->morality.value_or(0.0)) {}
+        /**
+        * \brief Возвращает текущую мораль отряда.
+        */
+        double& morality() {
+            return morality_;
+        }
          /**
         * \brief Наносит урон врагу с учетом морали.
         */
@@ -213,6 +324,10 @@ class MoralUnit : public RealUnit {
         * \brief Выполняет действия в текущем ходе, включая балансировку морали.
         */
         virtual void make_turn(Game& game, Team self_team) override;
+        /**
+        * \brief Выполняет намерение, включая балансировку морали.
+        */
+        void apply_turn(Game& game, Team self_team, const Intent& intent);
 };
 
 /**
@@ -225,22 +340,16 @@ class AmoralUnit : public RealUnit {
         * 
         * \param x Координата по горизонтальной оси.
         * \param y Координата по вертикальной оси.
-        * \param descriptor Дескриптор с характеристиками юнита.
+        * \param unit_template Шаблон с характеристиками юнита.
         */
-        AmoralUnit(int x, int y, UnitDescriptor& descriptor) : RealUnit(x, y, descriptor) {}
+        AmoralUnit(int x, int y, const UnitTemplate& unit_template, UnitKind kind = AMORAL) : RealUnit(x, y, unit_template, kind) {}
 };
 
 class RessurectionUnit : public RealUnit {
     private:
         std::shared_ptr<RealUnit> unit_;
     public:
-        RessurectionUnit(int x, int y, UnitDescriptor& descriptor) : RealUnit(x, y, descriptor) {
-            if (descriptor.morality == std::nullopt) {
-                unit_ = std::make_shared<AmoralUnit>(x, y, descriptor);
-            } else {
-                unit_ = std::make_shared<MoralUnit>(x, y, descriptor);
-            }
-        }
+        RessurectionUnit(int x, int y, const UnitTemplate& unit_template, std::shared_ptr<RealUnit> unit) : RealUnit(x, y, unit_template, RESSURECTION), unit_(std::move(unit)) {}
         virtual std::shared_ptr<RealUnit>& unit() {
             return unit_;
         }
@@ -250,27 +359,39 @@ class RessurectionUnit : public RealUnit {
         virtual int& y() override {
             return unit_->y();
         }
-        UnitDescriptor& characteristics() override {
-            return unit_->characteristics();
-        } 
-        void take_damage(double damage) override {
-            unit_->take_damage(damage);
-        };
-        void make_damage(Game& game, unit_t enemy) override {
-            unit_->make_damage(game, enemy);
-        };
+        void take_damage(double damage) override;
+        void make_damage(Game& game, unit_t enemy) override;
         void move(Game& game, int x, int y) override {
             unit_->move(game, x, y);   
         }
+        Expected<void> try_move(Game& game, int x, int y) override {
+            return unit_->try_move(game, x, y);
+        }
         void make_turn(Game&, Team self_team) override;
+        Intent plan_turn(Game& game, Team self_team);
+        void apply_turn(Game& game, Team self_team, const Intent& intent);
         double damage() override {
             return unit_->characteristics().damage;    
         }
         double& initiative() override {
-            return unit_->characteristics().initiative;
+            return unit_->initiative();
         }
         double& current_HP() override {
-            return unit_->characteristics().current_HP;
+            return unit_->current_HP();
+        }
+        int& amount() override {
+            return unit_->amount();
+        }
+        Symbol school() override {
+            return unit_->school();
+        }
+        void bind(UnitStore* store, uint32_t slot) override {
+            RealUnit::bind(store, slot);
+            unit_->bind(store, slot);
+        }
+        void unbind() override {
+            unit_->unbind();
+            RealUnit::unbind();
         }
         void death(Game& game) override {
             unit_->death(game);
@@ -278,19 +399,31 @@ class RessurectionUnit : public RealUnit {
         void update_amount() override {
             unit_->update_amount();
         }
-        double damage_coefficient(SchoolsTable& table, unit_t enemy) override {
+        double damage_coefficient(const SchoolsTable& table, unit_t enemy) override {
             return unit_->damage_coefficient(table, enemy);
         }
         double xp_for_destroy() override { 
             return unit_->xp_for_destroy();
         }
-        virtual void try_to_ressurect(); 
-        virtual void try_to_ressurect(std::mt19937 gen);
+        /**
+        * \brief Воскрешает часть погибших существ отряда.
+        *
+        * Число воскрешённых имеет геометрическое распределение, усечённое сверху
+        * числом погибших, и берётся одной выборкой по обратной функции распределения.
+        *
+        * \param gen Генератор случайных чисел.
+        */
+        template <class Generator>
+        void try_to_ressurect(Generator& gen) {
+            ressurect_(std::generate_canonical<double, std::numeric_limits<double>::digits>(gen));
+        }
+    private:
+        void ressurect_(double uniform);
 };
 
 class Kamikaze : public AmoralUnit {
     public:
-        Kamikaze(int x, int y, UnitDescriptor& descriptor) : AmoralUnit(x, y, descriptor) {}
+        Kamikaze(int x, int y, const UnitTemplate& unit_template) : AmoralUnit(x, y, unit_template, KAMIKAZE) {}
         void damage_all_enemies(Game& game, Team self_team);
         void make_turn(Game& game, Team self_team) override;
 };
@@ -298,16 +431,17 @@ class Kamikaze : public AmoralUnit {
 class Summoner : public BaseUnit {
     private:
         SummonerDescriptor characteristics_;
+        int amount_ = 1;
     public:
-        Summoner(int x, int y, SummonerDescriptor& descriptor) : BaseUnit(x, y), characteristics_(descriptor) {}
+        Summoner(int x, int y, SummonerDescriptor& descriptor) : BaseUnit(x, y, SUMMONER), characteristics_(descriptor) {}
         SummonerDescriptor& characteristics() {
             return characteristics_;
         }
         double& current_HP() override {
-            return characteristics().current_HP;
+            return store() != nullptr ? store()->hp[slot()] : characteristics().current_HP;
         }
         double& initiative() override {
-            return characteristics().initiative;
+            return store() != nullptr ? store()->initiative[slot()] : characteristics().initiative;
         }
         double damage() override {
             return characteristics().damage;
@@ -315,18 +449,28 @@ class Summoner : public BaseUnit {
         const std::string& name() override {
             return characteristics().name;
         }
-        int amount() override {
-            return 1;
+        Symbol school() override {
+            return Symbol();
+        }
+        int& amount() override {
+            return store() != nullptr ? store()->amount[slot()] : amount_;
         }
         double xp_for_destroy() override { return 0; }
         void make_turn(Game&, Team self_team) override;
         void accumulate_energy();
-        void upgrade_school(std::string& school_name);
-        void summon_unit(Game& game, const std::string& school_name, const std::string& skill_name, size_t x, size_t y);
-        double damage_coefficient(SchoolsTable& table, unit_t enemy) override;
+        void upgrade_school(Symbol school_name);
+        void summon_unit(Game& game, Symbol school_name, Symbol skill_name, size_t x, size_t y);
+        /**
+        * \brief Призыв без исключений.
+        *
+        * \return Пустой результат или NO_SUCH_SKILL, NOT_ENOUGH_KNOWLEDGE, NOT_ENOUGH_ENERGY, CELL_UNAVIALABLE.
+        */
+        Expected<void> try_summon_unit(Game& game, Symbol school_name, Symbol skill_name, size_t x, size_t y);
+        double damage_coefficient(const SchoolsTable& table, unit_t enemy) override;
         void take_damage(double damage) override;
         void make_damage(Game& game, unit_t enemy) override;
         void move(Game& game, int x, int y) override;
+        Expected<void> try_move(Game& game, int x, int y) override;
 };
 
 #endif
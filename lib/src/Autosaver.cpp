@@ -0,0 +1,128 @@
+#include "../include/Autosaver.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <vector>
+
+namespace {
+    constexpr size_t sequence_digits = 12;
+
+    // Номер автосохранения из имени файла; 0 для файлов другого вида, чтобы они считались самыми старыми
+    uint64_t sequence_of(const std::string& name) {
+        std::string_view rest = std::string_view(name).substr(std::string_view(AUTOSAVE_PREFIX).size());
+        if (rest.size() <= sequence_digits || rest[sequence_digits] != '-'
+            || !std::all_of(rest.begin(), rest.begin() + sequence_digits, [](char c){ return c >= '0' && c <= '9'; })) {
+            return 0;
+        }
+        return std::stoull(std::string(rest.substr(0, sequence_digits)));
+    }
+}
+
+Autosaver::Autosaver(std::string dir, size_t interval, size_t retained) : dir_(std::move(dir)), interval_(interval), retained_(retained) {
+    std::filesystem::create_directories(dir_);
+    for (const auto& save : saves_()) {
+        sequence_ = std::max(sequence_, save.first);
+    }
+    thread_ = std::thread([this](){ work_(); });
+}
+
+Autosaver::~Autosaver() {
+    {
+        std::lock_guard lock(mutex_);
+        stopping_ = true;
+    }
+    wake_.notify_one();
+    thread_.join();
+}
+
+void Autosaver::submit(uint64_t ticks, std::shared_ptr<const SaveSnapshot> snapshot) {
+    {
+        std::lock_guard lock(mutex_);
+        // Имя начинается с порядкового номера, а не со времени: перевод часов не меняет порядок имён
+        char name[64] = {0};
+        std::snprintf(name, sizeof(name), "%0*llu-%010llu", static_cast<int>(sequence_digits), static_cast<unsigned long long>(++sequence_), static_cast<unsigned long long>(ticks));
+        auto job = std::make_unique<Job>(Job{(std::filesystem::path(dir_) / (AUTOSAVE_PREFIX + std::string(name) + SAVE_FILE_EXTENSION)).string(), std::move(snapshot)});
+        if (pending_ != nullptr) {
+            ++dropped_;
+        }
+        pending_ = std::move(job);
+    }
+    wake_.notify_one();
+}
+
+void Autosaver::flush() {
+    std::unique_lock lock(mutex_);
+    idle_.wait(lock, [this](){ return pending_ == nullptr && !writing_; });
+}
+
+size_t Autosaver::written() const {
+    std::lock_guard lock(mutex_);
+    return written_;
+}
+
+size_t Autosaver::dropped() const {
+    std::lock_guard lock(mutex_);
+    return dropped_;
+}
+
+std::string Autosaver::last_error() const {
+    std::lock_guard lock(mutex_);
+    return last_error_;
+}
+
+std::string Autosaver::last_path() const {
+    std::lock_guard lock(mutex_);
+    return last_path_;
+}
+
+void Autosaver::work_() {
+    std::unique_lock lock(mutex_);
+    while (true) {
+        wake_.wait(lock, [this](){ return pending_ != nullptr || stopping_; });
+        if (pending_ == nullptr) {
+            return;
+        }
+        auto job = std::move(pending_);
+        writing_ = true;
+        lock.unlock();
+        std::string error;
+        try {
+            SaveFile::write(job->path, *job->snapshot, true);
+            prune_();
+        }
+        catch (const std::exception& e) {
+            error = e.what();
+        }
+        lock.lock();
+        writing_ = false;
+        if (error.empty()) {
+            ++written_;
+            last_path_ = job->path;
+        } else {
+            last_error_ = error;
+        }
+        idle_.notify_all();
+    }
+}
+
+std::vector<std::pair<uint64_t, std::filesystem::path>> Autosaver::saves_() const {
+    std::vector<std::pair<uint64_t, std::filesystem::path>> saves;
+    for (const auto& entry : std::filesystem::directory_iterator(dir_)) {
+        std::string name = entry.path().filename().string();
+        if (entry.is_regular_file() && name.starts_with(AUTOSAVE_PREFIX) && entry.path().extension() == SAVE_FILE_EXTENSION) {
+            saves.emplace_back(sequence_of(name), entry.path());
+        }
+    }
+    std::sort(saves.begin(), saves.end());
+    return saves;
+}
+
+void Autosaver::prune_() const {
+    if (retained_ == 0) {
+        return;
+    }
+    auto saves = saves_();
+    for (size_t i = 0; i + retained_ < saves.size(); ++i) {
+        std::filesystem::remove(saves[i].second);
+    }
+}
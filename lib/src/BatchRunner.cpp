@@ -0,0 +1,80 @@
+#include "../include/BatchRunner.hpp"
+#include <chrono>
+#include <utility>
+
+size_t BatchReport::total_ticks() const {
+    size_t ticks = 0;
+    for (const auto& match : matches) {
+        ticks += match.ticks;
+    }
+    return ticks;
+}
+
+size_t BatchReport::wins(Team team) const {
+    size_t amount = 0;
+    for (const auto& match : matches) {
+        amount += match.winner == team;
+    }
+    return amount;
+}
+
+size_t BatchReport::draws() const {
+    size_t amount = 0;
+    for (const auto& match : matches) {
+        amount += match.winner == std::nullopt && match.error.empty();
+    }
+    return amount;
+}
+
+BatchRunner::BatchRunner(const MatchConfig& config, size_t threads) : threads_(threads), serial_(std::make_shared<TaskScheduler>(0)) {
+    prototype_ = std::make_unique<Game>(config.units_dir, config.skills_dir, config.schools_dir, config.player_summoner_path, config.enemy_summoner_path, config.field_path);
+    catalog_ = prototype_->catalog();
+}
+
+MatchResult BatchRunner::run_match(size_t index, uint64_t seed, size_t tick_limit) const {
+    MatchResult result;
+    result.index = index;
+    result.seed = seed;
+    auto start = std::chrono::steady_clock::now();
+    Game game{catalog_, std::as_const(*prototype_).field()};
+    game.interactive() = false;
+    game.seed(seed);
+    game.set_scheduler(serial_);
+    for (const auto& units : {prototype_->teammates(), prototype_->enemies()}) {
+        auto& summoner = static_cast<Summoner&>(*units.front());
+        auto copy = std::make_shared<Summoner>(summoner.x(), summoner.y(), summoner.characteristics());
+        game.deploy_unit(summoner.x(), summoner.y(), copy, summoner.characteristics().team);
+    }
+    try {
+        game.game_start();
+        while (game.is_active() && game.ticks() < tick_limit) {
+            game.do_tick();
+        }
+    }
+    catch (const std::exception& e) {
+        if (game.winner() == std::nullopt) {
+            result.error = e.what();
+        }
+    }
+    result.winner = game.winner();
+    result.ticks = game.ticks();
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return result;
+}
+
+BatchReport BatchRunner::run(size_t matches, uint64_t base_seed, size_t tick_limit) {
+    BatchReport report;
+    report.matches.resize(matches);
+    auto start = std::chrono::steady_clock::now();
+    {
+        TaskScheduler scheduler(threads_ == 0 ? TaskScheduler::default_workers() : threads_ - 1, 1);
+        report.threads = scheduler.workers() + 1;
+        scheduler.parallel_for(0, matches, 1, [&](size_t first, size_t last){
+            for (size_t i = first; i < last; ++i) {
+                report.matches[i] = run_match(i, base_seed + i, tick_limit);
+            }
+        });
+    }
+    report.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return report;
+}
@@ -0,0 +1,90 @@
+#include "../include/BinaryFile.hpp"
+#include <atomic>
+#include <filesystem>
+#include <stdexcept>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+uint32_t StringTable::add(std::string_view string) {
+    auto [found, inserted] = ids_.try_emplace(std::string(string), strings_.size());
+    if (inserted) {
+        strings_.emplace_back(string);
+        characters_ += string.size();
+    }
+    return found->second;
+}
+
+void BinaryWriter::append(const StringTable& strings) {
+    std::vector<uint32_t> offsets{0};
+    std::string characters;
+    characters.reserve(strings.characters());
+    for (const auto& string : strings.strings()) {
+        characters += string;
+        offsets.push_back(characters.size());
+    }
+    append(offsets.data(), offsets.size());
+    append(characters.data(), characters.size());
+}
+
+void BinaryWriter::write_atomically(const std::string& path, const char* data, size_t size, bool sync) {
+    static std::atomic<unsigned> counter = 0;
+    std::string temporary = path + ".tmp." + std::to_string(getpid()) + "." + std::to_string(counter++);
+    int descriptor = open(temporary.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (descriptor < 0) {
+        throw std::runtime_error("Can't write " + path);
+    }
+    size_t written = 0;
+    while (written < size) {
+        ssize_t result = ::write(descriptor, data + written, size - written);
+        if (result < 0) {
+            break;
+        }
+        written += result;
+    }
+    bool failed = written != size || (sync && fsync(descriptor) != 0);
+    if (close(descriptor) != 0 || failed) {
+        std::filesystem::remove(temporary);
+        throw std::runtime_error("Can't write " + path);
+    }
+    std::error_code error;
+    std::filesystem::rename(temporary, path, error);
+    if (error) {
+        std::filesystem::remove(temporary, error);
+        throw std::runtime_error("Can't write " + path);
+    }
+}
+
+MappedFile::MappedFile(const std::string& path, size_t min_size) {
+    int descriptor = open(path.c_str(), O_RDONLY);
+    if (descriptor < 0) {
+        throw std::runtime_error("Can't open " + path);
+    }
+    struct stat info;
+    if (fstat(descriptor, &info) != 0 || static_cast<size_t>(info.st_size) < min_size) {
+        close(descriptor);
+        throw std::runtime_error(path + " is damaged");
+    }
+    size_ = info.st_size;
+    data_ = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, descriptor, 0);
+    close(descriptor);
+    if (data_ == MAP_FAILED) {
+        data_ = nullptr;
+        throw std::runtime_error("Can't map " + path);
+    }
+}
+
+MappedFile::MappedFile(std::vector<char> buffer, size_t min_size) : buffer_(std::move(buffer)) {
+    if (buffer_.size() < min_size) {
+        throw std::runtime_error("Buffer is damaged");
+    }
+    size_ = buffer_.size();
+    data_ = buffer_.data();
+}
+
+MappedFile::~MappedFile() {
+    if (data_ != nullptr && buffer_.empty()) {
+        munmap(data_, size_);
+    }
+}
@@ -0,0 +1,93 @@
+#include "../include/BuiltinCatalog.hpp"
+#include "../include/factory.hpp"
+#include "BuiltinCatalogData.hpp"
+#include <algorithm>
+
+namespace {
+    constexpr size_t schools_amount = builtin_data::schools.size();
+
+    constexpr bool references_valid() {
+        for (const auto& skill : builtin_data::skills) {
+            if (skill.unit >= builtin_data::units.size() || skill.kind == SUMMONER) {
+                return false;
+            }
+        }
+        for (uint32_t skill : builtin_data::school_skills) {
+            if (skill >= builtin_data::skills.size()) {
+                return false;
+            }
+        }
+        for (const auto& school : builtin_data::schools) {
+            if (school.first_skill + school.skills > builtin_data::school_skills.size() || school.first_dominant + school.dominants > builtin_data::dominants.size()) {
+                return false;
+            }
+        }
+        for (const auto& summoner : builtin_data::summoners) {
+            if (summoner.first_knowledge + summoner.knowledge > builtin_data::knowledge.size()) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Школа не может одновременно доминировать над другой и подчиняться ей
+    constexpr bool dominance_consistent() {
+        for (size_t i = 0; i < schools_amount; ++i) {
+            for (size_t j = 0; j < schools_amount; ++j) {
+                double one = builtin_data::coefficients[i * schools_amount + j];
+                double two = builtin_data::coefficients[j * schools_amount + i];
+                if ((one == DOMINANT_COEFFICIENT) != (two == SUBMISSIVE_COEFFICIENT) || (one == 1.0) != (two == 1.0)) {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    static_assert(builtin_data::coefficients.size() == schools_amount * schools_amount);
+    static_assert(references_valid(), "Built-in catalog refers to a missing unit, skill or school");
+    static_assert(dominance_consistent(), "Built-in catalog has contradictory dominance relations");
+
+    UnitDescriptor unit(uint32_t index) {
+        const BuiltinUnit& unit = builtin_data::units[index];
+        std::optional<double> morality = unit.moral ? std::optional<double>(unit.morality) : std::nullopt;
+        return UnitDescriptor(std::string(unit.name), std::string(unit.school), unit.initiative, unit.max_amount, unit.damage, unit.entity_HP, unit.speed, unit.defence, unit.xp_for_destroy, morality);
+    }
+
+    std::shared_ptr<const SchoolsTable> build() {
+        auto table = std::make_shared<SchoolsTable>();
+        for (uint32_t i = 0; i < builtin_data::units.size(); ++i) {
+            table->add_unit(unit(i));
+        }
+        for (const auto& record : builtin_data::schools) {
+            School school{std::string(record.name)};
+            for (uint32_t i = record.first_skill; i < record.first_skill + record.skills; ++i) {
+                const BuiltinSkill& skill = builtin_data::skills[builtin_data::school_skills[i]];
+                school.skills.emplace_back(unit(skill.unit), Factory::creator(skill.kind), std::string(skill.name), skill.min_knowledge, skill.required_energy, skill.knowledge_coefficient);
+            }
+            for (uint32_t i = record.first_dominant; i < record.first_dominant + record.dominants; ++i) {
+                school.dominant_for.push_back(builtin_data::dominants[i]);
+            }
+            table->add_school(school);
+        }
+        table->refresh_catalog();
+        return table;
+    }
+}
+
+std::shared_ptr<const SchoolsTable> BuiltinCatalog::schools_table() {
+    static const std::shared_ptr<const SchoolsTable> table = build();
+    return table;
+}
+
+std::optional<SummonerDescriptor> BuiltinCatalog::summoner(std::string_view file, Team team) {
+    auto found = std::find_if(builtin_data::summoners.begin(), builtin_data::summoners.end(), [&](const BuiltinSummoner& summoner){ return summoner.file == file; });
+    if (found == builtin_data::summoners.end()) {
+        return std::nullopt;
+    }
+    std::unordered_map<Symbol, double> schools_knowledge;
+    for (uint32_t i = found->first_knowledge; i < found->first_knowledge + found->knowledge; ++i) {
+        schools_knowledge[builtin_data::knowledge[i].school] = builtin_data::knowledge[i].knowledge;
+    }
+    return SummonerDescriptor(team, std::string(found->name), found->initiative, found->damage, found->max_HP, found->accumulation_coefficient, found->max_energy, schools_knowledge);
+}
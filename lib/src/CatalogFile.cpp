@@ -0,0 +1,382 @@
+#include "../include/CatalogFile.hpp"
+#include "../include/factory.hpp"
+#include "../include/UnitDispatch.hpp"
+#include "../include/TaskScheduler.hpp"
+#include "../../../../json/single_include/nlohmann/json.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <variant>
+using json = nlohmann::json;
+
+namespace {
+    constexpr char magic[8] = "SUMCAT";
+    constexpr uint32_t byte_order = 0x01020304;
+
+    UnitKind kind_of(const std::string& type) {
+        for (UnitKind kind : {MORAL, AMORAL, RESSURECTION, KAMIKAZE}) {
+            if (type == UnitDispatch::kind_name(kind)) {
+                return kind;
+            }
+        }
+        throw std::runtime_error("Unknown skill type " + type);
+    }
+
+    // Отряд, навык и школа в том виде, в каком они записаны в JSON. Символы здесь не
+    // создаются: их номера зависели бы от порядка работы потоков
+    struct UnitSource {
+        std::string name;
+        std::string school;
+        double initiative;
+        int max_amount;
+        double damage;
+        double entity_HP;
+        int speed;
+        double defence;
+        double xp_for_destroy;
+        std::optional<double> morality;
+        UnitDescriptor descriptor() const {
+            return UnitDescriptor(name, school, initiative, max_amount, damage, entity_HP, speed, defence, xp_for_destroy, morality);
+        }
+    };
+
+    struct SkillSource {
+        std::string name;
+        std::string entity;
+        UnitKind kind;
+        double min_knowledge;
+        double required_energy;
+        double knowledge_coefficient;
+    };
+
+    struct SchoolSource {
+        std::string name;
+        std::vector<std::string> skills;
+        std::vector<std::string> dominant_for;
+    };
+
+    enum SourceKind {
+        UNIT_SOURCE,
+        SKILL_SOURCE,
+        SCHOOL_SOURCE
+    };
+
+    struct SourceFile {
+        std::filesystem::path path;
+        SourceKind kind;
+    };
+
+    struct Parsed {
+        std::vector<std::variant<std::monostate, UnitSource, SkillSource, SchoolSource>> sources;
+        std::vector<std::string> errors;    ///< Пустая строка, если файл разобран
+    };
+
+    // Файлы каталога в порядке имён, чтобы сборка не зависела от файловой системы
+    std::vector<std::filesystem::path> list(const std::string& dir) {
+        std::vector<std::filesystem::path> paths;
+        for (const auto& entry : std::filesystem::directory_iterator(dir)) {
+            if (entry.is_regular_file()) {
+                paths.push_back(entry.path());
+            }
+        }
+        std::sort(paths.begin(), paths.end());
+        return paths;
+    }
+
+    UnitSource unit_from(const json& unit) {
+        std::optional<double> morality = std::nullopt;
+        if (unit.at("morality") != "NULL") {
+            morality = unit.at("morality").get<double>();
+        }
+        return {unit.at("name").get<std::string>(), unit.at("school").get<std::string>(), unit.at("initiative").get<double>(), unit.at("max_amount").get<int>(),
+            unit.at("damage").get<double>(), unit.at("entity_hp").get<double>(), unit.at("speed").get<int>(), unit.at("defence").get<double>(), unit.at("xp_for_destroy").get<double>(), morality};
+    }
+
+    SkillSource skill_from(const json& skill) {
+        return {skill.at("name").get<std::string>(), skill.at("entity").get<std::string>(), kind_of(skill.at("type").get<std::string>()),
+            skill.at("min_knowledge").get<double>(), skill.at("required_energy").get<double>(), skill.at("knowledge_coefficient").get<double>()};
+    }
+
+    SchoolSource school_from(const json& school) {
+        return {school.at("name").get<std::string>(), school.at("skills").get<std::vector<std::string>>(), school.at("dominant_for").get<std::vector<std::string>>()};
+    }
+
+    // Разбирает файлы параллельно; ошибка в файле записывается на его место и не мешает остальным
+    Parsed parse(const std::vector<SourceFile>& files, TaskScheduler* scheduler, size_t& threads) {
+        Parsed parsed;
+        parsed.sources.resize(files.size());
+        parsed.errors.resize(files.size());
+        std::optional<TaskScheduler> local;
+        if (scheduler == nullptr) {
+            local.emplace(files.size() > CATALOG_PARSE_GRAIN ? TaskScheduler::default_workers() : 0, CATALOG_PARSE_GRAIN);
+            scheduler = &*local;
+        }
+        threads = scheduler->workers() + 1;
+        scheduler->parallel_for(0, files.size(), CATALOG_PARSE_GRAIN, [&](size_t first, size_t last){
+            for (size_t i = first; i < last; ++i) {
+                try {
+                    std::ifstream file(files[i].path);
+                    json source = json::parse(file);
+                    switch (files[i].kind) {
+                        case UNIT_SOURCE:
+                            parsed.sources[i] = unit_from(source);
+                            break;
+                        case SKILL_SOURCE:
+                            parsed.sources[i] = skill_from(source);
+                            break;
+                        case SCHOOL_SOURCE:
+                            parsed.sources[i] = school_from(source);
+                            break;
+                    }
+                }
+                catch (const std::exception& e) {
+                    parsed.errors[i] = e.what();
+                }
+            }
+        });
+        return parsed;
+    }
+
+    std::filesystem::file_time_type newest(const std::string& dir) {
+        auto time = std::filesystem::last_write_time(dir);
+        for (const auto& entry : std::filesystem::directory_iterator(dir)) {
+            time = std::max(time, entry.last_write_time());
+        }
+        return time;
+    }
+}
+
+std::vector<UnitDescriptor> CatalogFile::read_units(const std::string& units_dir) {
+    std::vector<SourceFile> files;
+    for (auto& path : list(units_dir)) {
+        files.push_back({std::move(path), UNIT_SOURCE});
+    }
+    size_t threads = 0;
+    auto parsed = parse(files, nullptr, threads);
+    std::vector<UnitDescriptor> units;
+    for (size_t i = 0; i < files.size(); ++i) {
+        if (!parsed.errors[i].empty()) {
+            throw std::runtime_error(files[i].path.string() + ": " + parsed.errors[i]);
+        }
+        units.push_back(std::get<UnitSource>(parsed.sources[i]).descriptor());
+    }
+    return units;
+}
+
+CatalogReport CatalogFile::compile(const std::string& units_dir, const std::string& skills_dir, const std::string& schools_dir, const std::string& path, TaskScheduler* scheduler) {
+    auto start = std::chrono::steady_clock::now();
+    CatalogReport report;
+    assemble_(units_dir, skills_dir, schools_dir, scheduler, report).write(path);
+    report.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return report;
+}
+
+BinaryWriter CatalogFile::assemble_(const std::string& units_dir, const std::string& skills_dir, const std::string& schools_dir, TaskScheduler* scheduler, CatalogReport& report) {
+    std::vector<SourceFile> files;
+    for (auto [dir, kind] : {std::pair{&units_dir, UNIT_SOURCE}, std::pair{&skills_dir, SKILL_SOURCE}, std::pair{&schools_dir, SCHOOL_SOURCE}}) {
+        for (auto& file : list(*dir)) {
+            files.push_back({std::move(file), kind});
+        }
+    }
+    report.files = files.size();
+    auto parse_start = std::chrono::steady_clock::now();
+    auto parsed = parse(files, scheduler, report.threads);
+    report.parse_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - parse_start).count();
+    StringTable strings;
+    std::vector<CatalogUnit> units;
+    std::vector<CatalogSkill> skills;
+    std::vector<CatalogSchool> schools;
+    std::vector<uint32_t> links;
+    std::unordered_map<std::string, uint32_t> unit_ids;
+    std::unordered_map<std::string, uint32_t> skill_ids;
+    // Файлы идут в порядке: отряды, навыки, школы, поэтому ссылки всегда указывают назад
+    for (size_t i = 0; i < files.size(); ++i) {
+        auto error = [&](const std::string& message) { report.errors.push_back({files[i].path.string(), message}); };
+        if (!parsed.errors[i].empty()) {
+            error(parsed.errors[i]);
+        } else if (auto unit = std::get_if<UnitSource>(&parsed.sources[i])) {
+            unit_ids[unit->name] = units.size();
+            units.push_back({strings.add(unit->name), strings.add(unit->school), unit->max_amount, unit->speed, unit->initiative, unit->damage, unit->entity_HP, unit->defence, unit->xp_for_destroy, unit->morality.value_or(0.0), unit->morality.has_value(), 0});
+        } else if (auto skill = std::get_if<SkillSource>(&parsed.sources[i])) {
+            auto unit = unit_ids.find(skill->entity);
+            if (unit == unit_ids.end()) {
+                error("Unknown unit " + skill->entity);
+                continue;
+            }
+            skill_ids[skill->name] = skills.size();
+            skills.push_back({strings.add(skill->name), unit->second, skill->kind, 0, skill->min_knowledge, skill->required_energy, skill->knowledge_coefficient});
+        } else if (auto school = std::get_if<SchoolSource>(&parsed.sources[i])) {
+            CatalogSchool record{strings.add(school->name), static_cast<uint32_t>(links.size()), 0, 0, 0, 0};
+            for (const auto& name : school->skills) {
+                auto skill = skill_ids.find(name);
+                if (skill == skill_ids.end()) {
+                    error("Unknown skill " + name);
+                    continue;
+                }
+                links.push_back(skill->second);
+            }
+            record.skills = links.size() - record.first_skill;
+            record.first_dominant = links.size();
+            for (const auto& name : school->dominant_for) {
+                links.push_back(strings.add(name));
+            }
+            record.dominants = links.size() - record.first_dominant;
+            schools.push_back(record);
+        }
+    }
+    CatalogHeader header{};
+    std::memcpy(header.magic, magic, sizeof(magic));
+    header.version = CATALOG_VERSION;
+    header.byte_order = byte_order;
+    header.units = units.size();
+    header.skills = skills.size();
+    header.schools = schools.size();
+    header.links = links.size();
+    header.strings = strings.strings().size();
+    header.characters = strings.characters();
+    header.errors = report.errors.size();
+    BinaryWriter writer;
+    writer.append(&header, 1);
+    writer.append(units.data(), units.size());
+    writer.append(skills.data(), skills.size());
+    writer.append(schools.data(), schools.size());
+    writer.append(links.data(), links.size());
+    writer.append(strings);
+    return writer;
+}
+
+bool CatalogFile::stale(const std::string& path, const std::string& units_dir, const std::string& skills_dir, const std::string& schools_dir) {
+    std::error_code error;
+    auto built = std::filesystem::last_write_time(path, error);
+    if (error) {
+        return true;
+    }
+    CatalogHeader header{};
+    std::ifstream in(path, std::ios::binary);
+    if (!in.read(reinterpret_cast<char*>(&header), sizeof(header)) || std::memcmp(header.magic, magic, sizeof(magic)) != 0
+        || header.version != CATALOG_VERSION || header.byte_order != byte_order || header.errors != 0) {
+        return true;
+    }
+    return newest(units_dir) > built || newest(skills_dir) > built || newest(schools_dir) > built;
+}
+
+std::string CatalogFile::default_path(const std::string& units_dir) {
+    std::filesystem::path dir(units_dir);
+    if (!dir.has_filename()) {
+        dir = dir.parent_path();
+    }
+    return (dir.parent_path() / CATALOG_FILE_NAME).string();
+}
+
+std::shared_ptr<const SchoolsTable> CatalogFile::load(const std::string& units_dir, const std::string& skills_dir, const std::string& schools_dir, CatalogReport* report) {
+    auto start = std::chrono::steady_clock::now();
+    CatalogReport result;
+    std::string path = default_path(units_dir);
+    std::shared_ptr<const SchoolsTable> table;
+    if (stale(path, units_dir, skills_dir, schools_dir)) {
+        BinaryWriter writer = assemble_(units_dir, skills_dir, schools_dir, nullptr, result);
+        try {
+            writer.write(path);
+        }
+        catch (const std::runtime_error& e) {
+            result.errors.push_back({path, e.what()});
+            table = CatalogFile(writer.buffer()).schools_table();
+        }
+    }
+    if (table == nullptr) {
+        table = CatalogFile(path).schools_table();
+    }
+    if (report != nullptr) {
+        result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        *report = std::move(result);
+    }
+    return table;
+}
+
+CatalogFile::CatalogFile(const std::string& path) : file_(path, sizeof(CatalogHeader)) {
+    open_(path);
+}
+
+CatalogFile::CatalogFile(std::vector<char> buffer) : file_(std::move(buffer), sizeof(CatalogHeader)) {
+    open_("in memory");
+}
+
+void CatalogFile::open_(const std::string& path) {
+    const auto& header = file_.record<CatalogHeader>(0);
+    if (std::memcmp(header.magic, magic, sizeof(magic)) != 0 || header.version != CATALOG_VERSION || header.byte_order != byte_order) {
+        throw std::runtime_error("Catalog " + path + " has another version");
+    }
+    size_t expected = BinaryWriter::aligned(sizeof(CatalogHeader)) + BinaryWriter::aligned(sizeof(CatalogUnit) * header.units) + BinaryWriter::aligned(sizeof(CatalogSkill) * header.skills)
+        + BinaryWriter::aligned(sizeof(CatalogSchool) * header.schools) + BinaryWriter::aligned(sizeof(uint32_t) * header.links) + strings_size(header.strings, header.characters);
+    if (expected != file_.size()) {
+        throw std::runtime_error("Catalog " + path + " is damaged");
+    }
+    size_t offset = BinaryWriter::aligned(sizeof(CatalogHeader));
+    units_ = file_.section<CatalogUnit>(offset, header.units);
+    skills_ = file_.section<CatalogSkill>(offset, header.skills);
+    schools_ = file_.section<CatalogSchool>(offset, header.schools);
+    links_ = file_.section<uint32_t>(offset, header.links);
+    offsets_ = file_.section<uint32_t>(offset, header.strings + size_t(1));
+    characters_ = file_.data() + offset;
+    if (!strings_valid(offsets_, header.characters)) {
+        throw std::runtime_error("Catalog " + path + " is damaged");
+    }
+    for (const auto& unit : units_) {
+        if (unit.name >= header.strings || unit.school >= header.strings) {
+            throw std::runtime_error("Catalog " + path + " is damaged");
+        }
+    }
+    for (const auto& skill : skills_) {
+        if (skill.name >= header.strings || skill.unit >= header.units || skill.kind > KAMIKAZE) {
+            throw std::runtime_error("Catalog " + path + " is damaged");
+        }
+    }
+    for (const auto& school : schools_) {
+        if (school.name >= header.strings || school.first_skill + size_t(school.skills) > header.links || school.first_dominant + size_t(school.dominants) > header.links) {
+            throw std::runtime_error("Catalog " + path + " is damaged");
+        }
+        for (uint32_t link : links_.subspan(school.first_skill, school.skills)) {
+            if (link >= header.skills) {
+                throw std::runtime_error("Catalog " + path + " is damaged");
+            }
+        }
+        for (uint32_t link : links_.subspan(school.first_dominant, school.dominants)) {
+            if (link >= header.strings) {
+                throw std::runtime_error("Catalog " + path + " is damaged");
+            }
+        }
+    }
+}
+
+std::string_view CatalogFile::string(uint32_t index) const {
+    return std::string_view(characters_ + offsets_[index], offsets_[index + 1] - offsets_[index]);
+}
+
+UnitDescriptor CatalogFile::unit(uint32_t index) const {
+    const CatalogUnit& unit = units_[index];
+    std::optional<double> morality = unit.has_morality ? std::optional<double>(unit.morality) : std::nullopt;
+    return UnitDescriptor(std::string(string(unit.name)), std::string(string(unit.school)), unit.initiative, unit.max_amount, unit.damage, unit.entity_HP, unit.speed, unit.defence, unit.xp_for_destroy, morality);
+}
+
+std::shared_ptr<const SchoolsTable> CatalogFile::schools_table() const {
+    auto table = std::make_shared<SchoolsTable>();
+    for (uint32_t i = 0; i < units_.size(); ++i) {
+        table->add_unit(unit(i));
+    }
+    for (const auto& record : schools_) {
+        School school{std::string(string(record.name))};
+        for (uint32_t link : links_.subspan(record.first_skill, record.skills)) {
+            const CatalogSkill& skill = skills_[link];
+            school.skills.emplace_back(unit(skill.unit), Factory::creator(static_cast<UnitKind>(skill.kind)), std::string(string(skill.name)), skill.min_knowledge, skill.required_energy, skill.knowledge_coefficient);
+        }
+        for (uint32_t link : links_.subspan(record.first_dominant, record.dominants)) {
+            school.dominant_for.push_back(string(link));
+        }
+        table->add_school(school);
+    }
+    table->refresh_catalog();
+    return table;
+}
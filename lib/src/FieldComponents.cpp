@@ -0,0 +1,214 @@
+#include "../include/FieldComponents.hpp"
+#include <algorithm>
+#include <numeric>
+
+namespace {
+    // Соседи клетки по кругу: соседние в списке клетки касаются друг друга
+    constexpr int ring[8][2] = {{-1, -1}, {-1, 0}, {-1, 1}, {0, 1}, {1, 1}, {1, 0}, {1, -1}, {0, -1}};
+}
+
+void FieldComponents::build(const Grid<GameCell>& field) {
+    const int rows = field.rows();
+    const int columns = field.columns();
+    labels_ = Grid<uint32_t>(rows, columns, none);
+    marks_ = Grid<uint32_t>(rows, columns, 0);
+    mark_base_ = 0;
+    parent_.clear();
+    rank_.clear();
+    count_ = 0;
+    uint32_t* labels = labels_.data();
+    const GameCell* cells = field.data();
+    std::vector<uint32_t> frontier;
+    for (uint32_t start = 0; start < field.size(); ++start) {
+        if (labels[start] != none || cells[start].type() == OBSTACLE) {
+            continue;
+        }
+        uint32_t label = new_label_();
+        ++count_;
+        labels[start] = label;
+        frontier.assign(1, start);
+        for (size_t head = 0; head < frontier.size(); ++head) {
+            int x = frontier[head] / columns;
+            int y = frontier[head] % columns;
+            for (int next_x = std::max(x - 1, 0); next_x <= std::min(x + 1, rows - 1); ++next_x) {
+                for (int next_y = std::max(y - 1, 0); next_y <= std::min(y + 1, columns - 1); ++next_y) {
+                    uint32_t next = next_x * columns + next_y;
+                    if (labels[next] == none && cells[next].type() != OBSTACLE) {
+                        labels[next] = label;
+                        frontier.push_back(next);
+                    }
+                }
+            }
+        }
+    }
+}
+
+void FieldComponents::update(const Grid<GameCell>& field, int x, int y) {
+    if (!in_field_(x, y)) {
+        return;
+    }
+    bool land = field(x, y).type() != OBSTACLE;
+    if (land == (labels_(x, y) != none)) {
+        return;
+    }
+    if (land) {
+        uint32_t joined = none;
+        for (auto [dx, dy] : ring) {
+            if (!in_field_(x + dx, y + dy) || labels_(x + dx, y + dy) == none) {
+                continue;
+            }
+            if (joined == none) {
+                joined = labels_(x + dx, y + dy);
+            } else if (unite_(joined, labels_(x + dx, y + dy))) {
+                --count_;
+            }
+        }
+        if (joined == none) {
+            joined = new_label_();
+            ++count_;
+        }
+        labels_(x, y) = joined;
+        return;
+    }
+    labels_(x, y) = none;
+    int group[8];
+    bool present[8];
+    for (int i = 0; i < 8; ++i) {
+        present[i] = in_field_(x + ring[i][0], y + ring[i][1]) && labels_(x + ring[i][0], y + ring[i][1]) != none;
+        group[i] = i;
+    }
+    auto find = [&](int i) { while (group[i] != i) { i = group[i]; } return i; };
+    auto join = [&](int a, int b) {
+        if (present[a] && present[b]) {
+            group[find(a)] = find(b);
+        }
+    };
+    for (int i = 0; i < 8; ++i) {
+        join(i, (i + 1) % 8);
+    }
+    for (int i = 1; i < 8; i += 2) {
+        join(i, (i + 2) % 8);
+    }
+    std::vector<uint32_t> seeds;
+    for (int i = 0; i < 8; ++i) {
+        if (present[i] && find(i) == i) {
+            seeds.push_back((x + ring[i][0]) * labels_.columns() + y + ring[i][1]);
+        }
+    }
+    if (seeds.empty()) {
+        --count_;
+    } else if (seeds.size() > 1) {
+        split_(seeds);
+    }
+}
+
+uint32_t FieldComponents::component(int x, int y) const {
+    if (!in_field_(x, y) || labels_(x, y) == none) {
+        return none;
+    }
+    return root_(labels_(x, y));
+}
+
+uint32_t FieldComponents::root_(uint32_t label) const {
+    while (parent_[label] != label) {
+        label = parent_[label];
+    }
+    return label;
+}
+
+uint32_t FieldComponents::new_label_() {
+    parent_.push_back(parent_.size());
+    rank_.push_back(0);
+    return parent_.size() - 1;
+}
+
+bool FieldComponents::unite_(uint32_t a, uint32_t b) {
+    a = root_(a);
+    b = root_(b);
+    if (a == b) {
+        return false;
+    }
+    if (rank_[a] < rank_[b]) {
+        std::swap(a, b);
+    }
+    parent_[b] = a;
+    if (rank_[a] == rank_[b]) {
+        ++rank_[a];
+    }
+    return true;
+}
+
+void FieldComponents::split_(const std::vector<uint32_t>& seeds) {
+    const uint32_t groups = seeds.size();
+    if (mark_base_ >= std::numeric_limits<uint32_t>::max() - groups) {
+        marks_.fill(0);
+        mark_base_ = 0;
+    }
+    const uint32_t base = mark_base_ + 1;
+    mark_base_ += groups;
+    const int rows = labels_.rows();
+    const int columns = labels_.columns();
+    uint32_t* labels = labels_.data();
+    uint32_t* marks = marks_.data();
+    std::vector<std::vector<uint32_t>> visited(groups);
+    std::vector<size_t> head(groups, 0);
+    std::vector<uint32_t> owner(groups);
+    std::vector<bool> closed(groups, false);
+    std::iota(owner.begin(), owner.end(), 0);
+    auto find = [&](uint32_t g) { while (owner[g] != g) { g = owner[g]; } return g; };
+    for (uint32_t g = 0; g < groups; ++g) {
+        marks[seeds[g]] = base + g;
+        visited[g].push_back(seeds[g]);
+    }
+    // Поиски идут по очереди по одной клетке; встретившиеся поиски сливаются, а поиск,
+    // которому некуда идти, нашёл отрезанную часть
+    size_t open = groups;
+    while (open > 1) {
+        for (uint32_t g = 0; g < groups && open > 1; ++g) {
+            if (head[g] == visited[g].size()) {
+                continue;
+            }
+            uint32_t cell = visited[g][head[g]++];
+            int x = cell / columns;
+            int y = cell % columns;
+            for (int next_x = std::max(x - 1, 0); next_x <= std::min(x + 1, rows - 1); ++next_x) {
+                for (int next_y = std::max(y - 1, 0); next_y <= std::min(y + 1, columns - 1); ++next_y) {
+                    uint32_t next = next_x * columns + next_y;
+                    if (labels[next] == none) {
+                        continue;
+                    }
+                    if (marks[next] < base || marks[next] >= base + groups) {
+                        marks[next] = base + g;
+                        visited[g].push_back(next);
+                    } else if (uint32_t a = find(g), b = find(marks[next] - base); a != b) {
+                        owner[b] = a;
+                        --open;
+                    }
+                }
+            }
+        }
+        for (uint32_t g = 0; g < groups && open > 1; ++g) {
+            if (closed[g] || find(g) != g) {
+                continue;
+            }
+            bool exhausted = true;
+            for (uint32_t h = 0; h < groups && exhausted; ++h) {
+                exhausted = find(h) != g || head[h] == visited[h].size();
+            }
+            if (!exhausted) {
+                continue;
+            }
+            closed[g] = true;
+            uint32_t label = new_label_();
+            for (uint32_t h = 0; h < groups; ++h) {
+                if (find(h) == g) {
+                    for (uint32_t cell : visited[h]) {
+                        labels[cell] = label;
+                    }
+                }
+            }
+            ++count_;
+            --open;
+        }
+    }
+}
@@ -0,0 +1,45 @@
+#include "../include/FlowField.hpp"
+
+void FlowField::build(const Grid<GameCell>& field, const std::vector<point_t>& targets, const std::vector<point_t>& seekers) {
+    if (distance_.rows() != field.rows() || distance_.columns() != field.columns()) {
+        distance_ = Grid<uint32_t>(field.rows(), field.columns());
+    }
+    distance_.fill(unreachable);
+    frontier_.clear();
+    const int rows = field.rows();
+    const int columns = field.columns();
+    uint32_t* distance = distance_.data();
+    const GameCell* cells = field.data();
+    for (auto [x, y] : targets) {
+        if (in_field_(x, y) && distance[x * columns + y] == unreachable) {
+            distance[x * columns + y] = 0;
+            frontier_.push_back(x * columns + y);
+        }
+    }
+    wanted_.assign(seekers.empty() ? 0 : field.size(), false);
+    size_t left = 0;
+    for (auto [x, y] : seekers) {
+        if (in_field_(x, y) && !wanted_[x * columns + y]) {
+            wanted_[x * columns + y] = true;
+            ++left;
+        }
+    }
+    for (size_t head = 0; head < frontier_.size(); ++head) {
+        uint32_t cell = frontier_[head];
+        if (!wanted_.empty() && wanted_[cell] && --left == 0) {
+            break;
+        }
+        int x = cell / columns;
+        int y = cell % columns;
+        uint32_t next_distance = distance[cell] + 1;
+        for (int next_x = std::max(x - 1, 0); next_x <= std::min(x + 1, rows - 1); ++next_x) {
+            for (int next_y = std::max(y - 1, 0); next_y <= std::min(y + 1, columns - 1); ++next_y) {
+                uint32_t next = next_x * columns + next_y;
+                if (distance[next] == unreachable && cells[next].type() != OBSTACLE) {
+                    distance[next] = next_distance;
+                    frontier_.push_back(next);
+                }
+            }
+        }
+    }
+}
@@ -1,4 +1,5 @@
 #include "../include/game.hpp"
+#include "../include/SaveFile.hpp"
 #include <limits>
 #include <iostream>
 #include <chrono>
@@ -15,7 +16,11 @@ void GameManager::start_menu(Game& game, const std::string& units_dir) {
         std::cout << "\n" << "Enter path to save:\n";
         std::getline(std::cin, path);
         std::cout << "\n";
-        game.read_save(path, units_dir);
+        if (SaveFile::is_snapshot(path)) {
+            game.read_snapshot(path, units_dir);
+        } else {
+            game.read_save(path, units_dir);
+        }
     }
 }
 
@@ -126,7 +131,7 @@ void GameManager::process_actions(Game& game, Summoner& player) {
                 std::time_t now = std::chrono::system_clock::to_time_t(std::chrono::system_clock::now());
                 char buf[128] = {0};
                 std::strftime(buf, sizeof(buf), "%Y-%m-%d-%H-%M-%S", std::localtime(&now));
-                game.write_save("../../data/UserSaves/" + std::string(buf) + ".json");
+                game.write_snapshot("../../data/UserSaves/" + std::string(buf) + SAVE_FILE_EXTENSION);
                 std::cout << "Bye!\n\n";
                 game.is_active() = false;
                 turn_made = true;
@@ -2,6 +2,7 @@
 #include "../include/GameView.hpp"
 #include <iostream>
 #include <iomanip>
+#include <utility>
 
 std::string GameView::get_short_name(const std::string& name) {
     std::istringstream iss(name);
@@ -23,25 +24,27 @@ std::string GameView::get_hp(double hp) {
 }
 
 void GameView::draw_field(Game& game) {
-    Matrix<std::string, FIELD_WEIGHT, FIELD_HEIGHT> units;
-    units.fill(" ");
+    size_t width = game.field_width();
+    size_t height = game.field_height();
+    const Grid<GameCell>& field = std::as_const(game).field();
+    Grid<std::string> units(height, width, " ");
     for (const auto& unit : game.teammates()) {
         units.at(unit->y(), unit->x()) = get_short_name(unit->name()) + "(F, " + get_hp(unit->current_HP()) + "HP)";
     }
     for (const auto& unit : game.enemies()) {
         units.at(unit->y(), unit->x()) = get_short_name(unit->name() )+ "(E, " + get_hp(unit->current_HP()) + "HP)";
     }
-    std::vector<size_t> column_widths(FIELD_WEIGHT, 0);
-    for (size_t j = 0; j < FIELD_WEIGHT; ++j) {
-        for (size_t i = 0; i < FIELD_HEIGHT; ++i) {
-            size_t cell_length = (game.field().at(j, i).type() == OBSTACLE) ? 1 : units.at(i, j).length();
+    std::vector<size_t> column_widths(width, 0);
+    for (size_t j = 0; j < width; ++j) {
+        for (size_t i = 0; i < height; ++i) {
+            size_t cell_length = (field.at(j, i).type() == OBSTACLE) ? 1 : units.at(i, j).length();
             column_widths[j] = std::max(column_widths[j], cell_length);
         }
     }
-    for (size_t i = 0; i < FIELD_HEIGHT; ++i) {
-        for (size_t j = 0; j < FIELD_WEIGHT; ++j) {
+    for (size_t i = 0; i < height; ++i) {
+        for (size_t j = 0; j < width; ++j) {
             std::cout << "[";
-            if (game.field().at(j, i).type() == OBSTACLE) {
+            if (field.at(j, i).type() == OBSTACLE) {
                 std::cout << std::setw(column_widths[j]) << "X";
             } else {
                 std::cout << std::setw(column_widths[j]) << units.at(i, j);
@@ -75,7 +78,11 @@ void GameView::print_schools(Game& game) {
 void GameView::print_skills(Game& game, Summoner& player) {
     for (auto& school : player.characteristics().schools_knowledge) {
         std::cout << "School " << school.first << " (your knowledge is " << school.second << " %):" << "\n\n";
-        for (auto& skill : game.schools_table().table()[school.first].skills) {
+        const School* known = game.schools_table().find_school(school.first);
+        if (known == nullptr) {
+            continue;
+        }
+        for (auto& skill : known->skills) {
             std::cout << "Skill: " << skill.name << "\n";
             std::cout << "Unit name: " << skill.characteristics.name << "\n";
             std::cout << "Damage: " << skill.characteristics.damage << "\n";
@@ -104,7 +111,7 @@ void GameView::print_team(Game& game, Summoner& player, Team team) {
 }
 
 void GameView::print_parameters(Game& game, Summoner& player) {
-        std::cout << "HP: " << player.characteristics().current_HP << "\n";
+        std::cout << "HP: " << player.current_HP() << "\n";
         std::cout << "Energy: " << player.characteristics().current_energy << " / " << player.characteristics().max_energy << "\n";
         std::cout << "Damage: " << player.characteristics().damage << "\n";
         std::cout << "XP: " << player.characteristics().left_XP << "\n";
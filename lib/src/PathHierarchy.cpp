@@ -0,0 +1,376 @@
+#include "../include/PathHierarchy.hpp"
+#include <algorithm>
+
+namespace {
+    constexpr int wide_entrance = 6;    // Начиная с этой ширины вход представлен двумя крайними клетками
+    constexpr size_t max_searches = 256; // Сколько обходов от целей хранить, прежде чем начать заново
+    constexpr uint64_t goal_node = std::numeric_limits<uint64_t>::max();
+
+    uint64_t node_key(uint32_t border, size_t transition, bool outer) {
+        return (static_cast<uint64_t>(border) << 16) | (transition << 1) | static_cast<uint64_t>(outer);
+    }
+}
+
+PathHierarchy::PathHierarchy(int cluster_size) : cluster_size_(std::clamp(cluster_size, 2, 1 << 14)) {}
+
+void PathHierarchy::invalidate(int x, int y) {
+    if (!stale_ && x >= 0 && y >= 0 && x < cluster_rows_ * cluster_size_ && y < cluster_columns_ * cluster_size_) {
+        dirty_.push_back(cluster_of_(x, y));
+    }
+}
+
+void PathHierarchy::refresh(const Grid<GameCell>& field) {
+    int rows = (static_cast<int>(field.rows()) + cluster_size_ - 1) / cluster_size_;
+    int columns = (static_cast<int>(field.columns()) + cluster_size_ - 1) / cluster_size_;
+    if (rows != cluster_rows_ || columns != cluster_columns_) {
+        stale_ = true;
+    }
+    field_ = &field;
+    if (stale_) {
+        cluster_rows_ = rows;
+        cluster_columns_ = columns;
+        clusters_ = std::vector<Cluster>(static_cast<size_t>(rows) * columns);
+        borders_.assign(clusters_.size() * 4, {});
+        for (uint32_t cluster = 0; cluster < clusters_.size(); ++cluster) {
+            for (Side side : {SOUTH, EAST, SOUTH_EAST, SOUTH_WEST}) {
+                build_border_(cluster, side);
+            }
+        }
+        dirty_.clear();
+        stale_ = false;
+        searches_.clear();
+        return;
+    }
+    if (dirty_.empty()) {
+        return;
+    }
+    searches_.clear();
+    std::sort(dirty_.begin(), dirty_.end());
+    dirty_.erase(std::unique(dirty_.begin(), dirty_.end()), dirty_.end());
+    for (uint32_t cluster : dirty_) {
+        int row = cluster / cluster_columns_;
+        int column = cluster % cluster_columns_;
+        for (Side side : {SOUTH, EAST, SOUTH_EAST, SOUTH_WEST}) {
+            build_border_(cluster, side);
+        }
+        if (row > 0) {
+            build_border_(cluster - cluster_columns_, SOUTH);
+        }
+        if (column > 0) {
+            build_border_(cluster - 1, EAST);
+        }
+        if (row > 0 && column > 0) {
+            build_border_(cluster - cluster_columns_ - 1, SOUTH_EAST);
+        }
+        if (row > 0 && column + 1 < cluster_columns_) {
+            build_border_(cluster - cluster_columns_ + 1, SOUTH_WEST);
+        }
+        for (int near_row = std::max(row - 1, 0); near_row <= std::min(row + 1, cluster_rows_ - 1); ++near_row) {
+            for (int near_column = std::max(column - 1, 0); near_column <= std::min(column + 1, cluster_columns_ - 1); ++near_column) {
+                Cluster& near = clusters_[near_row * cluster_columns_ + near_column];
+                near.nodes.clear();
+                near.distance.clear();
+                near.ready.store(false, std::memory_order_relaxed);
+            }
+        }
+    }
+    dirty_.clear();
+}
+
+PathHierarchy::Bounds PathHierarchy::bounds_(uint32_t cluster) const {
+    int top = (cluster / cluster_columns_) * cluster_size_;
+    int left = (cluster % cluster_columns_) * cluster_size_;
+    return {top, left, std::min(top + cluster_size_, static_cast<int>(field_->rows())), std::min(left + cluster_size_, static_cast<int>(field_->columns()))};
+}
+
+bool PathHierarchy::neighbour_(uint32_t cluster, Side side, uint32_t& neighbour) const {
+    int row = cluster / cluster_columns_ + 1;
+    int column = cluster % cluster_columns_;
+    switch (side) {
+        case EAST:
+            --row;
+            ++column;
+            break;
+        case SOUTH_EAST:
+            ++column;
+            break;
+        case SOUTH_WEST:
+            --column;
+            break;
+        default:
+            break;
+    }
+    if (row >= cluster_rows_ || column < 0 || column >= cluster_columns_) {
+        return false;
+    }
+    neighbour = row * cluster_columns_ + column;
+    return true;
+}
+
+void PathHierarchy::build_border_(uint32_t cluster, Side side) {
+    auto& border = borders_[cluster * 4 + side];
+    border.clear();
+    uint32_t neighbour;
+    if (!neighbour_(cluster, side, neighbour)) {
+        return;
+    }
+    auto [top, left, bottom, right] = bounds_(cluster);
+    if (side == SOUTH_EAST || side == SOUTH_WEST) {
+        point_t inner = side == SOUTH_EAST ? point_t{bottom - 1, right - 1} : point_t{bottom - 1, left};
+        point_t outer = side == SOUTH_EAST ? point_t{bottom, right} : point_t{bottom, left - 1};
+        if (passable_(inner.first, inner.second) && passable_(outer.first, outer.second)) {
+            border.push_back({inner, outer});
+        }
+        return;
+    }
+    bool south = side == SOUTH;
+    int first = south ? left : top;
+    int last = south ? right : bottom;
+    auto inner_at = [&](int i){ return south ? point_t{bottom - 1, i} : point_t{i, right - 1}; };
+    auto outer_at = [&](int i){ return south ? point_t{bottom, i} : point_t{i, right}; };
+    auto open = [&](int i){ auto [x, y] = inner_at(i); auto [u, v] = outer_at(i); return passable_(x, y) && passable_(u, v); };
+    for (int i = first; i < last; ++i) {
+        if (!open(i)) {
+            continue;
+        }
+        int start = i;
+        while (i + 1 < last && open(i + 1)) {
+            ++i;
+        }
+        if (i - start + 1 < wide_entrance) {
+            int middle = (start + i) / 2;
+            border.push_back({inner_at(middle), outer_at(middle)});
+        } else {
+            border.push_back({inner_at(start), outer_at(start)});
+            border.push_back({inner_at(i), outer_at(i)});
+        }
+    }
+}
+
+PathHierarchy::point_t PathHierarchy::cell_of_(uint64_t node) const {
+    const Transition& transition = borders_[node >> 16][(node >> 1) & 0x7fff];
+    return (node & 1) ? transition.outer : transition.inner;
+}
+
+uint32_t PathHierarchy::node_cluster_(uint64_t node) const {
+    uint32_t owner = (node >> 16) / 4;
+    uint32_t neighbour = owner;
+    if (node & 1) {
+        neighbour_(owner, static_cast<Side>((node >> 16) % 4), neighbour);
+    }
+    return neighbour;
+}
+
+const PathHierarchy::Cluster& PathHierarchy::cluster_(uint32_t index) const {
+    Cluster& cluster = clusters_[index];
+    if (cluster.ready.load(std::memory_order_acquire)) {
+        return cluster;
+    }
+    std::lock_guard<std::mutex> lock(build_mutex_);
+    if (cluster.ready.load(std::memory_order_relaxed)) {
+        return cluster;
+    }
+    cluster.nodes.clear();
+    auto gather = [&](uint32_t owner, Side side, bool outer) {
+        uint32_t border = owner * 4 + side;
+        for (size_t transition = 0; transition < borders_[border].size(); ++transition) {
+            cluster.nodes.push_back(node_key(border, transition, outer));
+        }
+    };
+    for (Side side : {SOUTH, EAST, SOUTH_EAST, SOUTH_WEST}) {
+        gather(index, side, false);
+    }
+    int row = index / cluster_columns_;
+    int column = index % cluster_columns_;
+    if (row > 0) {
+        gather(index - cluster_columns_, SOUTH, true);
+    }
+    if (column > 0) {
+        gather(index - 1, EAST, true);
+    }
+    if (row > 0 && column > 0) {
+        gather(index - cluster_columns_ - 1, SOUTH_EAST, true);
+    }
+    if (row > 0 && column + 1 < cluster_columns_) {
+        gather(index - cluster_columns_ + 1, SOUTH_WEST, true);
+    }
+    size_t count = cluster.nodes.size();
+    cluster.distance.assign(count * count, unreachable);
+    auto [top, left, bottom, right] = bounds_(index);
+    int width = right - left;
+    std::vector<uint32_t> local;
+    for (size_t from = 0; from < count; ++from) {
+        auto [x, y] = cell_of_(cluster.nodes[from]);
+        local_distances_(index, x, y, local);
+        for (size_t to = 0; to < count; ++to) {
+            auto [to_x, to_y] = cell_of_(cluster.nodes[to]);
+            cluster.distance[from * count + to] = local[(to_x - top) * width + to_y - left];
+        }
+    }
+    ++built_clusters_;
+    cluster.ready.store(true, std::memory_order_release);
+    return cluster;
+}
+
+void PathHierarchy::local_distances_(uint32_t cluster, int x, int y, std::vector<uint32_t>& distance) const {
+    auto [top, left, bottom, right] = bounds_(cluster);
+    int height = bottom - top;
+    int width = right - left;
+    distance.assign(static_cast<size_t>(height) * width, unreachable);
+    std::vector<uint32_t> frontier;
+    frontier.reserve(distance.size());
+    uint32_t origin = (x - top) * width + y - left;
+    distance[origin] = 0;
+    frontier.push_back(origin);
+    for (size_t head = 0; head < frontier.size(); ++head) {
+        uint32_t cell = frontier[head];
+        int cell_x = cell / width;
+        int cell_y = cell % width;
+        uint32_t next_distance = distance[cell] + 1;
+        for (int next_x = std::max(cell_x - 1, 0); next_x <= std::min(cell_x + 1, height - 1); ++next_x) {
+            for (int next_y = std::max(cell_y - 1, 0); next_y <= std::min(cell_y + 1, width - 1); ++next_y) {
+                uint32_t next = next_x * width + next_y;
+                if (distance[next] == unreachable && passable_(top + next_x, left + next_y)) {
+                    distance[next] = next_distance;
+                    frontier.push_back(next);
+                }
+            }
+        }
+    }
+}
+
+size_t PathHierarchy::cached_goals() const {
+    std::lock_guard<std::mutex> lock(searches_mutex_);
+    return searches_.size();
+}
+
+std::shared_ptr<PathHierarchy::GoalSearch> PathHierarchy::search_(int goal_x, int goal_y) const {
+    uint64_t key = (static_cast<uint64_t>(goal_x) << 32) | static_cast<uint32_t>(goal_y);
+    {
+        std::lock_guard<std::mutex> lock(searches_mutex_);
+        auto found = searches_.find(key);
+        if (found != searches_.end()) {
+            return found->second;
+        }
+    }
+    auto search = std::make_shared<GoalSearch>();
+    uint32_t finish = cluster_of_(goal_x, goal_y);
+    auto [top, left, bottom, right] = bounds_(finish);
+    int width = right - left;
+    local_distances_(finish, goal_x, goal_y, search->local);
+    for (uint64_t node : cluster_(finish).nodes) {
+        auto [node_x, node_y] = cell_of_(node);
+        uint32_t cost = search->local[(node_x - top) * width + node_y - left];
+        if (cost != unreachable) {
+            relax_(*search, node, cost, goal_node);
+        }
+    }
+    std::lock_guard<std::mutex> lock(searches_mutex_);
+    if (searches_.size() >= max_searches) {
+        searches_.clear();
+    }
+    // Если другой поток успел начать обход к той же цели, используется его обход
+    return searches_.try_emplace(key, std::move(search)).first->second;
+}
+
+void PathHierarchy::relax_(GoalSearch& search, uint64_t node, uint32_t cost, uint64_t next) const {
+    auto [record, inserted] = search.records.try_emplace(node, Record{cost, next, false});
+    if (!inserted) {
+        if (record->second.settled || record->second.cost <= cost) {
+            return;
+        }
+        record->second.cost = cost;
+        record->second.next = next;
+    }
+    search.open.emplace(cost, node);
+}
+
+void PathHierarchy::expand_(GoalSearch& search, uint64_t node, uint32_t cost) const {
+    // Длины путей внутри кластера симметричны, поэтому обход от цели идёт по тем же рёбрам
+    const Cluster& cluster = cluster_(node_cluster_(node));
+    size_t count = cluster.nodes.size();
+    size_t from = std::find(cluster.nodes.begin(), cluster.nodes.end(), node) - cluster.nodes.begin();
+    for (size_t to = 0; to < count; ++to) {
+        uint32_t distance = cluster.distance[from * count + to];
+        if (to != from && distance != unreachable) {
+            relax_(search, cluster.nodes[to], cost + distance, node);
+        }
+    }
+    relax_(search, node ^ 1, cost + 1, node);
+}
+
+std::vector<PathHierarchy::point_t> PathHierarchy::route(int x, int y, int goal_x, int goal_y) const {
+    std::vector<point_t> waypoints;
+    auto inside = [this](int cell_x, int cell_y) {
+        return cell_x >= 0 && cell_y >= 0 && static_cast<size_t>(cell_x) < field_->rows() && static_cast<size_t>(cell_y) < field_->columns();
+    };
+    if (field_ == nullptr || clusters_.empty() || !inside(x, y) || !inside(goal_x, goal_y) || (x == goal_x && y == goal_y)) {
+        return waypoints;
+    }
+    uint32_t start = cluster_of_(x, y);
+    uint32_t finish = cluster_of_(goal_x, goal_y);
+    auto search = search_(goal_x, goal_y);
+    if (start == finish) {
+        auto [top, left, bottom, right] = bounds_(finish);
+        if (search->local[(x - top) * (right - left) + y - left] != unreachable) {
+            waypoints.emplace_back(goal_x, goal_y);
+            return waypoints;
+        }
+    }
+    auto [top, left, bottom, right] = bounds_(start);
+    int width = right - left;
+    std::vector<uint32_t> local;
+    local_distances_(start, x, y, local);
+    const Cluster& start_cluster = cluster_(start);
+    auto from_start = [&](uint64_t node) {
+        auto [node_x, node_y] = cell_of_(node);
+        return local[(node_x - top) * width + node_y - left];
+    };
+
+    std::lock_guard<std::mutex> lock(search->mutex);
+    uint64_t best = unreachable;
+    uint64_t first = goal_node;
+    auto consider = [&](uint64_t node, uint32_t cost) {
+        uint32_t distance = from_start(node);
+        if (distance != unreachable && distance + static_cast<uint64_t>(cost) < best) {
+            best = distance + static_cast<uint64_t>(cost);
+            first = node;
+        }
+    };
+    for (uint64_t node : start_cluster.nodes) {
+        auto record = search->records.find(node);
+        if (record != search->records.end() && record->second.settled) {
+            consider(node, record->second.cost);
+        }
+    }
+    // Обход продолжается, пока ещё не найденные входы кластера могут дать путь короче лучшего
+    while (!search->open.empty() && search->open.top().first < best) {
+        auto [cost, node] = search->open.top();
+        search->open.pop();
+        Record& record = search->records.find(node)->second;
+        if (record.settled || record.cost != cost) {
+            continue;
+        }
+        record.settled = true;
+        if (node_cluster_(node) == start) {
+            consider(node, cost);
+        }
+        expand_(*search, node, cost);
+    }
+    if (first == goal_node) {
+        return waypoints;
+    }
+    for (uint64_t node = first; node != goal_node; node = search->records.find(node)->second.next) {
+        point_t cell = cell_of_(node);
+        if (waypoints.empty() || cell != waypoints.back()) {
+            waypoints.push_back(cell);
+        }
+    }
+    if (waypoints.back() != point_t{goal_x, goal_y}) {
+        waypoints.emplace_back(goal_x, goal_y);
+    }
+    if (waypoints.front() == point_t{x, y}) {
+        waypoints.erase(waypoints.begin());
+    }
+    return waypoints;
+}
@@ -0,0 +1,67 @@
+#include "../include/SaveFile.hpp"
+#include "../include/descriptors.hpp"
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+namespace {
+    constexpr char magic[8] = "SUMSAVE";
+    constexpr uint32_t byte_order = 0x01020304;
+}
+
+void SaveFile::write(const std::string& path, const SaveSnapshot& snapshot, bool sync) {
+    SaveHeader header = snapshot.header;
+    std::memcpy(header.magic, magic, sizeof(magic));
+    header.version = SAVE_VERSION;
+    header.byte_order = byte_order;
+    header.units = snapshot.units.size();
+    header.knowledge = snapshot.knowledge.size();
+    header.strings = snapshot.strings.strings().size();
+    header.characters = snapshot.strings.characters();
+    BinaryWriter writer;
+    writer.append(&header, 1);
+    writer.append(snapshot.units.data(), snapshot.units.size());
+    writer.append(snapshot.knowledge.data(), snapshot.knowledge.size());
+    writer.append(snapshot.strings);
+    writer.write(path, sync);
+}
+
+bool SaveFile::is_snapshot(const std::string& path) {
+    char bytes[sizeof(magic)] = {};
+    std::ifstream in(path, std::ios::binary);
+    return in.read(bytes, sizeof(bytes)) && std::memcmp(bytes, magic, sizeof(magic)) == 0;
+}
+
+SaveFile::SaveFile(const std::string& path) : file_(path, sizeof(SaveHeader)) {
+    header_ = &file_.record<SaveHeader>(0);
+    if (std::memcmp(header_->magic, magic, sizeof(magic)) != 0 || header_->version != SAVE_VERSION || header_->byte_order != byte_order) {
+        throw std::runtime_error("Save " + path + " has another version");
+    }
+    size_t expected = BinaryWriter::aligned(sizeof(SaveHeader)) + BinaryWriter::aligned(sizeof(SaveUnit) * header_->units)
+        + BinaryWriter::aligned(sizeof(SaveKnowledge) * header_->knowledge) + strings_size(header_->strings, header_->characters);
+    if (expected != file_.size()) {
+        throw std::runtime_error("Save " + path + " is damaged");
+    }
+    size_t offset = BinaryWriter::aligned(sizeof(SaveHeader));
+    units_ = file_.section<SaveUnit>(offset, header_->units);
+    knowledge_ = file_.section<SaveKnowledge>(offset, header_->knowledge);
+    offsets_ = file_.section<uint32_t>(offset, header_->strings + size_t(1));
+    characters_ = file_.data() + offset;
+    if (!strings_valid(offsets_, header_->characters)) {
+        throw std::runtime_error("Save " + path + " is damaged");
+    }
+    for (const auto& unit : units_) {
+        if (unit.name >= header_->strings || unit.kind > SUMMONER || unit.team > ENEMY || unit.first_knowledge + size_t(unit.knowledge) > knowledge_.size()) {
+            throw std::runtime_error("Save " + path + " is damaged");
+        }
+    }
+    for (const auto& knowledge : knowledge_) {
+        if (knowledge.school >= header_->strings) {
+            throw std::runtime_error("Save " + path + " is damaged");
+        }
+    }
+}
+
+std::string_view SaveFile::string(uint32_t index) const {
+    return std::string_view(characters_ + offsets_[index], offsets_[index + 1] - offsets_[index]);
+}
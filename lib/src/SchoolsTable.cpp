@@ -1,24 +1,168 @@
 #include "../include/SchoolsTable.hpp"
+#include <algorithm>
+#include <utility>
 
 void SchoolsTable::add_school(const School& school) {
    table()[school.name] = school; 
 }
 
+void SchoolsTable::build_catalog_() {
+    std::vector<const School*> schools;
+    uint32_t max_id = 0;
+    for (auto& [name, school] : table_) {
+        max_id = std::max(max_id, name.id());
+    }
+    school_index_.assign(table_.empty() ? 0 : max_id + 1, no_school_);
+    for (auto& [name, school] : table_) {
+        school_index_[name.id()] = schools.size();
+        schools.push_back(&school);
+    }
+    coefficients_.assign(schools.size() * schools.size(), 1.0);
+    for (size_t i = 0; i < schools.size(); ++i) {
+        for (size_t j = 0; j < schools.size(); ++j) {
+            if (*schools[i] > *schools[j]) {
+                coefficients_[i * schools.size() + j] = DOMINANT_COEFFICIENT;
+            } else if (*schools[j] > *schools[i]) {
+                coefficients_[i * schools.size() + j] = SUBMISSIVE_COEFFICIENT;
+            }
+        }
+    }
+    skill_index_.clear();
+    ranking_.clear();
+    for (auto& [name, school] : table_) {
+        auto& ranking = ranking_[name];
+        for (uint32_t i = 0; i < school.skills.size(); ++i) {
+            Skill& skill = school.skills[i];
+            auto known = units_.find(skill.characteristics.name);
+            skill.unit = known != units_.end() && *known->second == skill.characteristics ? known->second : UnitTemplate(skill.characteristics);
+            skill_index_.try_emplace(skill_key_(name, skill.name), i);
+            ranking.push_back({skill.required_energy, skill.min_knowledge, skill.characteristics.damage, i, 0});
+        }
+        std::stable_sort(ranking.begin(), ranking.end(), [](auto& one, auto& two) { return one.required_energy < two.required_energy; });
+        for (uint32_t i = 0; i < ranking.size(); ++i) {
+            ranking[i].best = i > 0 && ranking[ranking[i - 1].best].damage > ranking[i].damage ? ranking[i - 1].best : i;
+        }
+    }
+    catalog_stale_ = false;
+}
+
+const Skill* SchoolsTable::best_skill(Symbol school_name, double energy, double knowledge) const {
+    const School* school = find_school(school_name);
+    if (school == nullptr) {
+        return nullptr;
+    }
+    const Skill* chosen = nullptr;
+    if (catalog_stale_) {
+        for (auto& skill : school->skills) {
+            if (energy >= skill.required_energy && knowledge >= skill.min_knowledge && (chosen == nullptr || skill.characteristics.damage >= chosen->characteristics.damage)) {
+                chosen = &skill;
+            }
+        }
+        return chosen;
+    }
+    const auto& ranked = ranking_.at(school_name);
+    auto affordable = std::upper_bound(ranked.begin(), ranked.end(), energy, [](double energy, auto& skill) { return energy < skill.required_energy; });
+    if (affordable == ranked.begin()) {
+        return nullptr;
+    }
+    const RankedSkill* best = &ranked[(affordable - 1)->best];
+    if (knowledge < best->min_knowledge) {
+        best = nullptr;
+        for (auto skill = ranked.begin(); skill != affordable; ++skill) {
+            if (knowledge >= skill->min_knowledge && (best == nullptr || skill->damage >= best->damage)) {
+                best = &*skill;
+            }
+        }
+    }
+    return best == nullptr ? nullptr : &school->skills[best->skill];
+}
+
+double SchoolsTable::coefficient(Symbol attacker, Symbol defender) const {
+    if (catalog_stale_) {
+        const School* one = find_school(attacker);
+        const School* two = find_school(defender);
+        if (one == nullptr || two == nullptr) {
+            return 1.0;
+        }
+        return *one > *two ? DOMINANT_COEFFICIENT : *two > *one ? SUBMISSIVE_COEFFICIENT : 1.0;
+    }
+    uint32_t a = attacker.id() < school_index_.size() ? school_index_[attacker.id()] : no_school_;
+    uint32_t d = defender.id() < school_index_.size() ? school_index_[defender.id()] : no_school_;
+    return a == no_school_ || d == no_school_ ? 1.0 : coefficients_[a * table_.size() + d];
+}
+
 void SchoolsTable::add_skill(const Skill& skill) {
     table()[skill.characteristics.school].skills.push_back(skill);
 }
 
-School& SchoolsTable::get_school(const std::string& name) {
-    return table()[name];
-} 
+void SchoolsTable::add_unit(const UnitDescriptor& unit) {
+    units_[unit.name] = unit;
+    catalog_stale_ = true;
+}
+
+UnitTemplate SchoolsTable::find_unit(Symbol name) const {
+    auto found = units_.find(name);
+    return found == units_.end() ? UnitTemplate() : found->second;
+}
 
-Skill& SchoolsTable::get_skill(const std::string& school_name, const std::string& skill_name) {
-    auto found = std::find_if(get_school(school_name).skills.begin(), get_school(school_name).skills.end(), [&](auto& skill){ return skill.name == skill_name; });
-    if (found == get_school(school_name).skills.end()) {
-        throw std::invalid_argument("No such skill");
-    } else {
-        return *found;
+School& SchoolsTable::get_school(Symbol name) {
+    catalog_stale_ = true;
+    return table_.try_emplace(name, name).first->second;
+}
+
+const School& SchoolsTable::get_school(Symbol name) const {
+    const School* school = find_school(name);
+    if (school == nullptr) {
+        throw std::invalid_argument("No such school");
+    }
+    return *school;
+}
+
+const School* SchoolsTable::find_school(Symbol name) const {
+    auto found = table_.find(name);
+    return found == table_.end() ? nullptr : &found->second;
+}
+
+Skill& SchoolsTable::get_skill(Symbol school_name, Symbol skill_name) {
+    Skill& skill = const_cast<Skill&>(std::as_const(*this).get_skill(school_name, skill_name));
+    catalog_stale_ = true;
+    return skill;
+}
+
+const Skill& SchoolsTable::get_skill(Symbol school_name, Symbol skill_name) const {
+    auto found = find_skill(school_name, skill_name);
+    if (!found) {
+        throw std::invalid_argument(describe(found.error()));
+    }
+    return **found;
+}
+
+Expected<Skill*> SchoolsTable::find_skill(Symbol school_name, Symbol skill_name) {
+    auto found = std::as_const(*this).find_skill(school_name, skill_name);
+    if (!found) {
+        return Unexpected(found.error());
+    }
+    catalog_stale_ = true;
+    return const_cast<Skill*>(*found);
+}
+
+Expected<const Skill*> SchoolsTable::find_skill(Symbol school_name, Symbol skill_name) const {
+    const School* school = find_school(school_name);
+    if (school == nullptr) {
+        return Unexpected(NO_SUCH_SKILL);
+    }
+    if (catalog_stale_) {
+        auto found = std::find_if(school->skills.begin(), school->skills.end(), [&](auto& skill){ return skill.name == skill_name; });
+        if (found == school->skills.end()) {
+            return Unexpected(NO_SUCH_SKILL);
+        }
+        return &*found;
+    }
+    auto found = skill_index_.find(skill_key_(school_name, skill_name));
+    if (found == skill_index_.end()) {
+        return Unexpected(NO_SUCH_SKILL);
     }
+    return &school->skills[found->second];
 }
 
 size_t SchoolsTable::schools_amount() const {
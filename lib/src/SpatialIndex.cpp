@@ -0,0 +1,164 @@
+#include "../include/SpatialIndex.hpp"
+#include <algorithm>
+#include <cmath>
+#include <queue>
+
+SpatialIndex::SpatialIndex(int width, int height, int bucket_size) : bucket_size_(std::max(bucket_size, 1)) {
+    columns_ = std::max((width + bucket_size_ - 1) / bucket_size_, 1);
+    rows_ = std::max((height + bucket_size_ - 1) / bucket_size_, 1);
+    buckets_.resize(static_cast<size_t>(columns_) * rows_);
+}
+
+int SpatialIndex::bucket_size_for(int width, int height) {
+    int64_t cells = static_cast<int64_t>(std::max(width, 0)) * std::max(height, 0);
+    return std::max(8, static_cast<int>(std::ceil(std::sqrt(cells / 16384.0))));
+}
+
+int SpatialIndex::column_of_(int x) const {
+    return std::clamp(x / bucket_size_, 0, columns_ - 1);
+}
+
+int SpatialIndex::row_of_(int y) const {
+    return std::clamp(y / bucket_size_, 0, rows_ - 1);
+}
+
+void SpatialIndex::insert(uint32_t unit, int x, int y) {
+    bucket_(x, y).push_back({unit, x, y});
+    ++size_;
+}
+
+void SpatialIndex::erase(uint32_t unit, int x, int y) {
+    auto& bucket = bucket_(x, y);
+    auto found = std::find_if(bucket.begin(), bucket.end(), [=](const Entry& entry){ return entry.unit == unit; });
+    if (found != bucket.end()) {
+        *found = bucket.back();
+        bucket.pop_back();
+        --size_;
+    }
+}
+
+void SpatialIndex::move(uint32_t unit, int from_x, int from_y, int to_x, int to_y) {
+    auto& from = bucket_(from_x, from_y);
+    auto& to = bucket_(to_x, to_y);
+    if (&from == &to) {
+        auto found = std::find_if(from.begin(), from.end(), [=](const Entry& entry){ return entry.unit == unit; });
+        if (found != from.end()) {
+            found->x = to_x;
+            found->y = to_y;
+        }
+        return;
+    }
+    erase(unit, from_x, from_y);
+    insert(unit, to_x, to_y);
+}
+
+void SpatialIndex::clear() {
+    for (auto& bucket : buckets_) {
+        bucket.clear();
+    }
+    size_ = 0;
+}
+
+template <class F>
+void SpatialIndex::for_each_in_ring_(int column, int row, int ring, F&& f) const {
+    int top = row - ring;
+    int bottom = row + ring;
+    for (int c = std::max(column - ring, 0); c <= std::min(column + ring, columns_ - 1); ++c) {
+        if (top >= 0) {
+            for (const auto& entry : buckets_[top * columns_ + c]) { f(entry); }
+        }
+        if (ring != 0 && bottom < rows_) {
+            for (const auto& entry : buckets_[bottom * columns_ + c]) { f(entry); }
+        }
+    }
+    for (int r = std::max(top + 1, 0); r <= std::min(bottom - 1, rows_ - 1); ++r) {
+        if (column - ring >= 0) {
+            for (const auto& entry : buckets_[r * columns_ + column - ring]) { f(entry); }
+        }
+        if (column + ring < columns_) {
+            for (const auto& entry : buckets_[r * columns_ + column + ring]) { f(entry); }
+        }
+    }
+}
+
+template <class Accept>
+uint32_t SpatialIndex::nearest_(int x, int y, Accept&& accept) const {
+    uint32_t best = npos;
+    if (empty()) {
+        return best;
+    }
+    int64_t best_distance = 0;
+    int column = column_of_(x);
+    int row = row_of_(y);
+    int max_ring = std::max(std::max(column, columns_ - 1 - column), std::max(row, rows_ - 1 - row));
+    for (int ring = 0; ring <= max_ring; ++ring) {
+        for_each_in_ring_(column, row, ring, [&](const Entry& entry) {
+            int64_t distance = distance2(x, y, entry.x, entry.y);
+            if ((best == npos || distance < best_distance) && accept(entry.unit)) {
+                best = entry.unit;
+                best_distance = distance;
+            }
+        });
+        if (best != npos && best_distance <= ring_bound_(ring)) {
+            break;
+        }
+    }
+    return best;
+}
+
+uint32_t SpatialIndex::nearest(int x, int y) const {
+    return nearest_(x, y, [](uint32_t){ return true; });
+}
+
+uint32_t SpatialIndex::nearest_if(int x, int y, const std::function<bool(uint32_t)>& accept) const {
+    return nearest_(x, y, accept);
+}
+
+std::vector<uint32_t> SpatialIndex::k_nearest(int x, int y, size_t k) const {
+    using candidate_t = std::pair<int64_t, uint32_t>;
+    std::priority_queue<candidate_t> closest;
+    if (k == 0 || empty()) {
+        return {};
+    }
+    int column = column_of_(x);
+    int row = row_of_(y);
+    int max_ring = std::max(std::max(column, columns_ - 1 - column), std::max(row, rows_ - 1 - row));
+    for (int ring = 0; ring <= max_ring; ++ring) {
+        for_each_in_ring_(column, row, ring, [&](const Entry& entry) {
+            int64_t distance = distance2(x, y, entry.x, entry.y);
+            if (closest.size() < k) {
+                closest.emplace(distance, entry.unit);
+            } else if (distance < closest.top().first) {
+                closest.pop();
+                closest.emplace(distance, entry.unit);
+            }
+        });
+        if (closest.size() == k && closest.top().first <= ring_bound_(ring)) {
+            break;
+        }
+    }
+    std::vector<uint32_t> result(closest.size());
+    for (auto i = result.rbegin(); i != result.rend(); ++i) {
+        *i = closest.top().second;
+        closest.pop();
+    }
+    return result;
+}
+
+std::vector<uint32_t> SpatialIndex::within_radius(int x, int y, int radius) const {
+    std::vector<uint32_t> result;
+    if (radius < 0) {
+        return result;
+    }
+    int64_t radius2 = static_cast<int64_t>(radius) * radius;
+    for (int r = row_of_(y - radius); r <= row_of_(y + radius); ++r) {
+        for (int c = column_of_(x - radius); c <= column_of_(x + radius); ++c) {
+            for (const auto& entry : buckets_[r * columns_ + c]) {
+                if (distance2(x, y, entry.x, entry.y) <= radius2) {
+                    result.push_back(entry.unit);
+                }
+            }
+        }
+    }
+    return result;
+}
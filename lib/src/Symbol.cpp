@@ -0,0 +1,51 @@
+#include "../include/Symbol.hpp"
+#include <deque>
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_map>
+
+namespace {
+    struct Names {
+        std::shared_mutex mutex;
+        std::deque<std::string> names{""};  // deque не перемещает строки при добавлении
+        std::unordered_map<std::string_view, uint32_t> ids{{names.front(), 0}};
+    };
+
+    Names& names() {
+        static Names instance;
+        return instance;
+    }
+}
+
+Symbol::Symbol(std::string_view name) {
+    Names& table = names();
+    {
+        std::shared_lock<std::shared_mutex> lock(table.mutex);
+        auto found = table.ids.find(name);
+        if (found != table.ids.end()) {
+            id_ = found->second;
+            return;
+        }
+    }
+    std::unique_lock<std::shared_mutex> lock(table.mutex);
+    auto found = table.ids.find(name);
+    if (found != table.ids.end()) {
+        id_ = found->second;
+        return;
+    }
+    id_ = table.names.size();
+    table.names.emplace_back(name);
+    table.ids.emplace(table.names.back(), id_);
+}
+
+const std::string& Symbol::name() const {
+    Names& table = names();
+    std::shared_lock<std::shared_mutex> lock(table.mutex);
+    return table.names[id_];
+}
+
+size_t Symbol::count() {
+    Names& table = names();
+    std::shared_lock<std::shared_mutex> lock(table.mutex);
+    return table.names.size();
+}
@@ -0,0 +1,84 @@
+#include "../include/TaskScheduler.hpp"
+
+static thread_local const TaskScheduler* current_scheduler = nullptr;
+static thread_local size_t current_queue = 0;
+
+size_t TaskScheduler::default_workers() {
+    size_t hardware = std::thread::hardware_concurrency();
+    return hardware <= 1 ? 0 : hardware - 1;
+}
+
+TaskScheduler::TaskScheduler(size_t workers, size_t serial_cutoff) : serial_cutoff_(serial_cutoff) {
+    for (size_t i = 0; i <= workers; ++i) {
+        queues_.push_back(std::make_unique<Queue>());
+    }
+    for (size_t i = 0; i < workers; ++i) {
+        threads_.emplace_back([this, i](){ work_(i); });
+    }
+}
+
+TaskScheduler::~TaskScheduler() {
+    {
+        std::lock_guard lock(sleep_mutex_);
+        stopping_ = true;
+    }
+    wake_.notify_all();
+    for (auto& thread : threads_) {
+        thread.join();
+    }
+}
+
+size_t TaskScheduler::home_() const {
+    return current_scheduler == this ? current_queue : threads_.size();
+}
+
+void TaskScheduler::push_(size_t queue, std::function<void()> task) {
+    {
+        std::lock_guard lock(queues_[queue]->mutex);
+        queues_[queue]->tasks.push_back(std::move(task));
+    }
+    {
+        std::lock_guard lock(sleep_mutex_);
+        ++pending_;
+    }
+    wake_.notify_one();
+}
+
+bool TaskScheduler::run_one_(size_t home) {
+    std::function<void()> task;
+    for (size_t i = 0; i < queues_.size() && task == nullptr; ++i) {
+        Queue& queue = *queues_[(home + i) % queues_.size()];
+        std::lock_guard lock(queue.mutex);
+        if (queue.tasks.empty()) {
+            continue;
+        }
+        if (i == 0) {
+            task = std::move(queue.tasks.back());
+            queue.tasks.pop_back();
+        } else {
+            task = std::move(queue.tasks.front());
+            queue.tasks.pop_front();
+        }
+    }
+    if (task == nullptr) {
+        return false;
+    }
+    --pending_;
+    task();
+    return true;
+}
+
+void TaskScheduler::work_(size_t index) {
+    current_scheduler = this;
+    current_queue = index;
+    while (true) {
+        if (run_one_(index)) {
+            continue;
+        }
+        std::unique_lock lock(sleep_mutex_);
+        wake_.wait(lock, [this](){ return stopping_ || pending_ != 0; });
+        if (stopping_ && pending_ == 0) {
+            return;
+        }
+    }
+}
@@ -0,0 +1,42 @@
+#include "../include/UnitPool.hpp"
+#include <new>
+
+UnitPool::~UnitPool() {
+    for (auto slab : slabs_) {
+        ::operator delete(slab, std::align_val_t(alignment));
+    }
+}
+
+void UnitPool::grow_(size_t size_class) {
+    size_t block_size = size_class * alignment;
+    auto slab = static_cast<std::byte*>(::operator new(block_size * blocks_per_slab, std::align_val_t(alignment)));
+    slabs_.push_back(slab);
+    for (size_t i = blocks_per_slab; i > 0; --i) {
+        auto block = reinterpret_cast<FreeBlock*>(slab + (i - 1) * block_size);
+        block->next = free_[size_class];
+        free_[size_class] = block;
+    }
+}
+
+void* UnitPool::allocate(size_t bytes) {
+    size_t size_class = size_class_(bytes == 0 ? 1 : bytes);
+    if (size_class >= free_.size()) {
+        free_.resize(size_class + 1, nullptr);
+    }
+    if (free_[size_class] == nullptr) {
+        grow_(size_class);
+    }
+    FreeBlock* block = free_[size_class];
+    free_[size_class] = block->next;
+    ++allocations_;
+    ++in_use_;
+    return block;
+}
+
+void UnitPool::deallocate(void* block, size_t bytes) noexcept {
+    size_t size_class = size_class_(bytes == 0 ? 1 : bytes);
+    auto free_block = static_cast<FreeBlock*>(block);
+    free_block->next = free_[size_class];
+    free_[size_class] = free_block;
+    --in_use_;
+}
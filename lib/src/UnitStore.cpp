@@ -0,0 +1,44 @@
+#include "../include/UnitStore.hpp"
+
+uint32_t UnitStore::acquire(BaseUnit* unit, Team unit_team, Symbol unit_school, UnitKind unit_kind) {
+    uint32_t slot;
+    if (free_.empty()) {
+        slot = owner.size();
+        x.push_back(0);
+        y.push_back(0);
+        hp.push_back(0);
+        amount.push_back(0);
+        initiative.push_back(0);
+        team.push_back(unit_team);
+        school.push_back(unit_school);
+        kind.push_back(unit_kind);
+        owner.push_back(unit);
+    } else {
+        slot = free_.back();
+        free_.pop_back();
+        team[slot] = unit_team;
+        school[slot] = unit_school;
+        kind[slot] = unit_kind;
+        owner[slot] = unit;
+    }
+    return slot;
+}
+
+void UnitStore::release(uint32_t slot) {
+    owner[slot] = nullptr;
+    hp[slot] = 0;
+    free_.push_back(slot);
+}
+
+void UnitStore::clear() {
+    x.clear();
+    y.clear();
+    hp.clear();
+    amount.clear();
+    initiative.clear();
+    team.clear();
+    school.clear();
+    kind.clear();
+    owner.clear();
+    free_.clear();
+}
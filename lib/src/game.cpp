@@ -1,61 +1,281 @@
 #include "../include/game.hpp"
 #include "../include/factory.hpp"
+#include "../include/CatalogFile.hpp"
+#include "../include/SaveFile.hpp"
+#ifdef SUMMONERS_BUILTIN_CATALOG
+#include "../include/BuiltinCatalog.hpp"
+#endif
+#include "../include/UnitDispatch.hpp"
 #include "../../../../json/single_include/nlohmann/json.hpp"
 #include <algorithm>
 #include <filesystem>
 #include <fstream>
 using json = nlohmann::json;
 
-bool Game::is_avialable(int x, int y) {
-    if (x >= FIELD_WEIGHT || y >= FIELD_HEIGHT || x < 0 || y < 0) { return false; }
-    return !(Game::field().at(x, y).type() == OBSTACLE || std::any_of(player_units_.begin(), player_units_.end(), [&](auto& unit) { return unit->x() == x && unit->y() == y; }) || std::any_of(enemy_units_.begin(), enemy_units_.end(), [&](auto& unit) { return unit->x() == x && unit->y() == y; }));
+bool Game::is_avialable(int x, int y) const {
+    return in_field(x, y) && field_(x, y).type() != OBSTACLE && occupancy_(x, y) == UnitStore::no_slot;
+}
+
+void Game::reset_layers_() {
+    for (auto& unit : player_units_) { unit->unbind(); }
+    for (auto& unit : enemy_units_) { unit->unbind(); }
+    store_.clear();
+    player_slots_.clear();
+    enemy_slots_.clear();
+    occupancy_ = Grid<uint32_t>(field_.rows(), field_.columns(), UnitStore::no_slot);
+    components_.build(field_);
+    components_stale_ = false;
+    player_components_.clear();
+    enemy_components_.clear();
+    occupied_stale_ = false;
+    int bucket_size = SpatialIndex::bucket_size_for(field_width(), field_height());
+    player_index_ = SpatialIndex(field_width(), field_height(), bucket_size);
+    enemy_index_ = SpatialIndex(field_width(), field_height(), bucket_size);
+    for (auto& unit : player_units_) {
+        track_(unit.get(), PLAYER);
+        player_slots_.push_back(unit->slot());
+    }
+    for (auto& unit : enemy_units_) {
+        track_(unit.get(), ENEMY);
+        enemy_slots_.push_back(unit->slot());
+    }
+}
+
+void Game::refresh_components_() {
+    if (components_stale_) {
+        components_.build(field_);
+        components_stale_ = false;
+    }
+}
+
+void Game::refresh_occupied_() {
+    refresh_components_();
+    for (Team team : {PLAYER, ENEMY}) {
+        auto& occupied = team == PLAYER ? player_components_ : enemy_components_;
+        occupied.clear();
+        for (auto slot : slots_(team)) {
+            occupied.push_back(components_.component(store_.x[slot], store_.y[slot]));
+        }
+        std::sort(occupied.begin(), occupied.end());
+        occupied.erase(std::unique(occupied.begin(), occupied.end()), occupied.end());
+    }
+    occupied_stale_ = false;
+}
+
+// Погибшие юниты из списков не убираются до следующего тика: лишняя компонента только отключает быстрый отказ
+void Game::occupy_(uint32_t slot) {
+    if (occupied_stale_ || components_stale_) {
+        return;
+    }
+    auto& occupied = store_.team[slot] == PLAYER ? player_components_ : enemy_components_;
+    uint32_t component = components_.component(store_.x[slot], store_.y[slot]);
+    auto position = std::lower_bound(occupied.begin(), occupied.end(), component);
+    if (position == occupied.end() || *position != component) {
+        occupied.insert(position, component);
+    }
+}
+
+Game::~Game() {
+    for (auto& unit : player_units_) { unit->unbind(); }
+    for (auto& unit : enemy_units_) { unit->unbind(); }
+}
+
+TaskScheduler& Game::scheduler() {
+    if (scheduler_ == nullptr) {
+        scheduler_ = std::make_shared<TaskScheduler>();
+    }
+    return *scheduler_;
+}
+
+void Game::track_(BaseUnit* unit, Team team) {
+    uint32_t slot = store_.acquire(unit, team, unit->school(), unit->kind());
+    unit->bind(&store_, slot);
+    if (in_field(unit->x(), unit->y())) {
+        occupancy_(unit->x(), unit->y()) = slot;
+        index_(team).insert(slot, unit->x(), unit->y());
+        occupy_(slot);
+    }
+}
+
+void Game::untrack_(BaseUnit& unit) {
+    if (unit.store() != &store_) {
+        return;
+    }
+    uint32_t slot = unit.slot();
+    if (in_field(unit.x(), unit.y()) && occupancy_(unit.x(), unit.y()) == slot) {
+        index_(store_.team[slot]).erase(slot, unit.x(), unit.y());
+        occupancy_(unit.x(), unit.y()) = UnitStore::no_slot;
+    }
+    unit.unbind();
+    store_.release(slot);
 }
 
 void Game::deploy_unit(int x, int y, std::shared_ptr<BaseUnit> unit, Team team) {
+    if (auto deployed = try_deploy(x, y, std::move(unit), team); !deployed) {
+        throw std::invalid_argument(describe(deployed.error()));
+    }
+}
+
+Expected<void> Game::try_deploy(int x, int y, std::shared_ptr<BaseUnit> unit, Team team) {
     if (!is_avialable(x, y)) {
-        throw std::invalid_argument("This cell is unavialable");
+        return Unexpected(CELL_UNAVIALABLE);
     }
     unit->x() = x;
     unit->y() = y;
-    if (team == PLAYER) {
-        player_units_.insert(std::upper_bound(player_units_.begin(), player_units_.end(), unit, [](auto unit_a, auto unit_b){ return unit_a->initiative() > unit_b->initiative(); }), unit);
-    } else {
-        enemy_units_.insert(std::upper_bound(enemy_units_.begin(), enemy_units_.end(), unit, [](auto unit_a, auto unit_b){ return unit_a->initiative() > unit_b->initiative(); }), unit);
+    auto& units = team == PLAYER ? player_units_ : enemy_units_;
+    auto& slots = slots_(team);
+    track_(unit.get(), team);
+    auto position = std::upper_bound(slots.begin(), slots.end(), unit->slot(), [&](uint32_t slot_a, uint32_t slot_b){ return store_.initiative[slot_a] > store_.initiative[slot_b]; });
+    units.insert(units.begin() + (position - slots.begin()), unit);
+    slots.insert(position, unit->slot());
+    return {};
+}
+
+void Game::move_unit(BaseUnit& unit, int x, int y) {
+    if (auto moved = try_move_unit(unit, x, y); !moved) {
+        throw std::invalid_argument(describe(moved.error()));
     }
 }
 
+Expected<void> Game::try_move_unit(BaseUnit& unit, int x, int y) {
+    if (!is_avialable(x, y)) {
+        return Unexpected(CELL_UNAVIALABLE);
+    }
+    if (unit.store() == &store_ && in_field(unit.x(), unit.y())) {
+        uint32_t slot = unit.slot();
+        index_(store_.team[slot]).move(slot, unit.x(), unit.y(), x, y);
+        occupancy_(unit.x(), unit.y()) = UnitStore::no_slot;
+        occupancy_(x, y) = slot;
+    }
+    unit.x() = x;
+    unit.y() = y;
+    if (unit.store() == &store_) {
+        occupy_(unit.slot());
+    }
+    return {};
+}
+
+void Game::set_cell(int x, int y, GameCell cell) {
+    field_.at(x, y) = cell;
+    player_paths_tick_ = enemy_paths_tick_ = std::numeric_limits<size_t>::max();
+    hierarchy_.invalidate(x, y);
+    if (!components_stale_) {
+        components_.update(field_, x, y);
+    }
+    occupied_stale_ = true;
+}
+
+void Game::update_paths(Team team) {
+    size_t& built = team == PLAYER ? player_paths_tick_ : enemy_paths_tick_;
+    if (built == ticks_) {
+        return;
+    }
+    if (hierarchical_()) {
+        if (occupied_stale_ || components_stale_) {
+            refresh_occupied_();
+        }
+        hierarchy_.refresh(field_);
+        built = ticks_;
+        return;
+    }
+    if (occupied_stale_ || components_stale_) {
+        refresh_occupied_();
+    }
+    std::vector<FlowField::point_t> targets;
+    std::vector<FlowField::point_t> seekers;
+    const auto& target_components = occupied_(team == PLAYER ? ENEMY : PLAYER);
+    for (auto slot : slots_(team == PLAYER ? ENEMY : PLAYER)) {
+        targets.emplace_back(store_.x[slot], store_.y[slot]);
+    }
+    for (auto slot : slots_(team)) {
+        if (store_.kind[slot] != SUMMONER && store_.kind[slot] != KAMIKAZE
+            && std::binary_search(target_components.begin(), target_components.end(), components_.component(store_.x[slot], store_.y[slot]))) {
+            seekers.emplace_back(store_.x[slot], store_.y[slot]);
+        }
+    }
+    if (!seekers.empty()) {
+        (team == PLAYER ? player_paths_ : enemy_paths_).build(field_, targets, seekers);
+    }
+    built = ticks_;
+}
+
+std::pair<int, int> Game::path_step(int x, int y, Team team, int steps) const {
+    auto available = [this](int next_x, int next_y){ return is_avialable(next_x, next_y); };
+    if (hierarchical_()) {
+        uint32_t target = closest_enemy_slot(x, y, team);
+        if (target == UnitStore::no_slot) {
+            return {x, y};
+        }
+        return hierarchy_.step(x, y, store_.x[target], store_.y[target], steps, available);
+    }
+    if (paths_(team).empty()) {
+        return {x, y};
+    }
+    return paths_(team).step(x, y, steps, available);
+}
+
+void Game::erase_dead_(units_t& units, std::vector<uint32_t>& slots) {
+    size_t kept = 0;
+    for (size_t i = 0; i < slots.size(); ++i) {
+        if (store_.hp[slots[i]] > 0) {
+            units[kept] = std::move(units[i]);
+            slots[kept] = slots[i];
+            ++kept;
+        } else {
+            untrack_(*units[i]);
+        }
+    }
+    units.resize(kept);
+    slots.resize(kept);
+}
+
 void Game::remove_dead() {
-    for (auto unit : player_units_) {
-        if (unit->current_HP() <= 0 && typeid(*unit) == typeid(Summoner)) {
+    for (auto slot : player_slots_) {
+        if (store_.hp[slot] <= 0 && store_.kind[slot] == SUMMONER) {
             game_over(ENEMY);
         }
     }
-    std::erase_if(player_units_, [](auto unit){ return unit->current_HP() <= 0; });
-    for (auto unit : enemy_units_) {
-        if (unit->current_HP() <= 0) {
-            add_xp(unit->xp_for_destroy());
-            if (typeid(*unit) == typeid(Summoner)) {
+    erase_dead_(player_units_, player_slots_);
+    for (auto slot : enemy_slots_) {
+        if (store_.hp[slot] <= 0) {
+            add_xp(store_.owner[slot]->xp_for_destroy());
+            if (store_.kind[slot] == SUMMONER) {
                 game_over(PLAYER);
             }
         }
     }
-    std::erase_if(enemy_units_, [](auto unit){ return unit->current_HP() <= 0; });
+    erase_dead_(enemy_units_, enemy_slots_);
 }
 
 void Game::remove_unit(std::shared_ptr<BaseUnit> unit) {
-    if (std::erase(player_units_, unit) == 0) {
-        std::erase(enemy_units_, unit);
+    for (auto team : {PLAYER, ENEMY}) {
+        auto& units = team == PLAYER ? player_units_ : enemy_units_;
+        auto found = std::find(units.begin(), units.end(), unit);
+        if (found != units.end()) {
+            slots_(team).erase(slots_(team).begin() + (found - units.begin()));
+            units.erase(found);
+            untrack_(*unit);
+            return;
+        }
+    }
+}
+
+void Game::sort_by_initiative_(units_t& units, std::vector<uint32_t>& slots) {
+    std::sort(slots.begin(), slots.end(), [&](uint32_t slot_a, uint32_t slot_b){ return store_.initiative[slot_a] > store_.initiative[slot_b]; });
+    for (size_t i = 0; i < slots.size(); ++i) {
+        units[i] = store_.owner[slots[i]]->shared_from_this();
     }
 }
 
 void Game::game_start() {
-    std::sort(player_units_.begin(), player_units_.end(), [](auto unit_a, auto unit_b){ return unit_a->initiative() > unit_b->initiative(); });
-    std::sort(enemy_units_.begin(), enemy_units_.end(), [](auto unit_a, auto unit_b){ return unit_a->initiative() > unit_b->initiative(); });
+    sort_by_initiative_(player_units_, player_slots_);
+    sort_by_initiative_(enemy_units_, enemy_slots_);
 }
 
 void Game::game_over(Team winner_team) {
-    throw std::runtime_error(winner_team == PLAYER ? "Player has won" : "Player has lost");
+    winner_ = winner_team;
     is_active() = false;
+    throw std::runtime_error(winner_team == PLAYER ? "Player has won" : "Player has lost");
 }
 
 bool Game::accessible_for_player(Summoner& player, int x, int y) {
@@ -63,110 +283,145 @@ bool Game::accessible_for_player(Summoner& player, int x, int y) {
 }
 
 std::shared_ptr<BaseUnit> Game::find_enemy(int x, int y, Team team) {
-    auto& units = team == PLAYER ? enemies() : teammates();
-    auto enemy = std::find_if(units.begin(), units.end(), [=](auto unit){ return unit->x() == x && unit->y() == y; });
-    if (enemy == units.end()) {
+    uint32_t slot = in_field(x, y) ? occupancy_(x, y) : UnitStore::no_slot;
+    if (slot == UnitStore::no_slot || store_.team[slot] == team) {
         throw std::runtime_error("No such enemy!");
     } else {
-        return *enemy;
+        return share_(slot);
     }
 }
 
-std::shared_ptr<BaseUnit> Game::find_closest_enemy(int x, int y, Team team) {
-    if (team == ENEMY) {
-        return *std::min_element(player_units_.begin(), player_units_.end(), [=](auto u_a, auto u_b){ return sqrt(pow(x - u_a->x(), 2) + pow(y - u_a->y(), 2)) < sqrt(pow(x - u_b->x(), 2) + pow(y - u_b->y(), 2)); });
-    } else {
-        return *std::min_element(enemy_units_.begin(), enemy_units_.end(), [=](auto u_a, auto u_b){ return sqrt(pow(x - u_a->x(), 2) + pow(y - u_a->y(), 2)) < sqrt(pow(x - u_b->x(), 2) + pow(y - u_b->y(), 2)); });
+uint32_t Game::closest_enemy_slot(int x, int y, Team team) const {
+    const SpatialIndex& enemies = index_(team == PLAYER ? ENEMY : PLAYER);
+    uint32_t component = components_stale_ ? FieldComponents::none : components_.component(x, y);
+    if (component == FieldComponents::none) {
+        return enemies.nearest(x, y);
+    }
+    const auto& occupied = occupied_(team == PLAYER ? ENEMY : PLAYER);
+    if (!occupied_stale_ && !std::binary_search(occupied.begin(), occupied.end(), component)) {
+        return SpatialIndex::npos;
     }
+    return enemies.nearest_if(x, y, [&](uint32_t slot){ return components_.component(store_.x[slot], store_.y[slot]) == component; });
 }
 
-void Game::do_tick() {
-    auto teammates_copy = player_units_;
-    auto enemies_copy = enemy_units_;
-    auto p_iter = teammates_copy.begin();
-    auto e_iter = enemies_copy.begin();
-    while (p_iter != teammates_copy.end() && e_iter != enemies_copy.end()) {
-        if ((*p_iter)->initiative() >= (*e_iter)->initiative()) {
-            (*p_iter)->make_turn(*this, PLAYER);
-            ++p_iter;
-        } else if ((*p_iter)->initiative() < (*e_iter)->initiative()) {
-            (*e_iter)->make_turn(*this, ENEMY);
-            ++e_iter;
-        }
+std::shared_ptr<BaseUnit> Game::find_closest_enemy(int x, int y, Team team) {
+    return share_(closest_enemy_slot(x, y, team));
+}
+
+Game::units_t Game::find_closest_enemies(int x, int y, Team team, size_t k) {
+    units_t closest;
+    for (auto slot : index_(team == PLAYER ? ENEMY : PLAYER).k_nearest(x, y, k)) {
+        closest.push_back(share_(slot));
     }
-    if (p_iter == teammates_copy.end()) {
-        std::for_each(e_iter, enemies_copy.end(), [&](auto unit){ unit->make_turn(*this, ENEMY); });
-    } else {
-        std::for_each(p_iter, teammates_copy.end(), [&](auto unit){ unit->make_turn(*this, PLAYER); });
+    return closest;
+}
+
+Game::units_t Game::find_enemies_within(int x, int y, Team team, int radius) {
+    units_t found;
+    for (auto slot : index_(team == PLAYER ? ENEMY : PLAYER).within_radius(x, y, radius)) {
+        found.push_back(share_(slot));
     }
-    remove_dead();
+    return found;
 }
 
-SchoolsTable Game::read_schools_table_(const std::string& units_dir, const std::string& skills_dir, const std::string& schools_dir) {
-    std::unordered_map<std::string, UnitDescriptor> unit_map;
-    std::unordered_map<std::string, Skill> skill_map;
-    std::unordered_map<std::string, School> school_map;
-    for (const auto& unit_json : std::filesystem::directory_iterator(units_dir)) {
-        std::ifstream json_file(unit_json.path());
-        json unit = json::parse(json_file);
-        std::optional<double> morality = std::nullopt;
-        if (unit["morality"] != "NULL") {
-            morality = unit["morality"];
+void Game::do_tick() {
+    ++ticks_;
+    if (own_schools_table_ != nullptr) {
+        own_schools_table_->refresh_catalog();
+    }
+    refresh_occupied_();
+    size_t allocations = pool_->allocations();
+    size_t heap_allocations = pool_->heap_allocations();
+    turn_order_.clear();
+    auto p_iter = player_slots_.begin();
+    auto e_iter = enemy_slots_.begin();
+    while (p_iter != player_slots_.end() && e_iter != enemy_slots_.end()) {
+        if (store_.initiative[*p_iter] >= store_.initiative[*e_iter]) {
+            turn_order_.emplace_back(*p_iter++, PLAYER);
         } else {
-            morality = std::nullopt;
-        }
-        UnitDescriptor ud(unit["name"], unit["school"], unit["initiative"], unit["max_amount"], unit["damage"], unit["entity_hp"], unit["speed"], unit["defence"], unit["xp_for_destroy"], morality);
-        unit_map[ud.name] = ud;
-    }
-    for (const auto& skill_json : std::filesystem::directory_iterator(skills_dir)) {
-        std::ifstream skill_file(skill_json.path());
-        json skill = json::parse(skill_file);
-        std::function<std::shared_ptr<BaseUnit>(UnitDescriptor&)> create;
-        if (skill["type"] == "Moral") {
-            create = Factory::create_moral_unit;
-        } else if (skill["type"] == "Amoral") {
-            create = Factory::create_amoral_unit;
-        } else if (skill["type"] == "Ressurection") {
-            create = Factory::create_ressurection_unit;
-        } else if (skill["type"] == "Kamikaze") {
-            create = Factory::create_kamikaze;
+            turn_order_.emplace_back(*e_iter++, ENEMY);
         }
-        Skill sk(unit_map[skill["entity"]], create, skill["name"], skill["min_knowledge"], skill["required_energy"], skill["knowledge_coefficient"]);
-        skill_map[sk.name] = sk;
-    }
-    for (const auto& school_json : std::filesystem::directory_iterator(schools_dir)) {
-        std::ifstream school_file(school_json.path());
-        json school = json::parse(school_file);
-        std::vector<Skill> vec_skills;
-        std::vector<std::string> vec_relations;
-        for (auto& skill : school["skills"]) {
-            vec_skills.push_back(skill_map[skill]);
+    }
+    std::for_each(e_iter, enemy_slots_.end(), [&](uint32_t slot){ turn_order_.emplace_back(slot, ENEMY); });
+    std::for_each(p_iter, player_slots_.end(), [&](uint32_t slot){ turn_order_.emplace_back(slot, PLAYER); });
+    if (tick_mode_ == TWO_PHASE) {
+        update_paths(PLAYER);
+        update_paths(ENEMY);
+        intents_.resize(turn_order_.size());
+        scheduler().parallel_for(0, turn_order_.size(), 64, [&](size_t first, size_t last) {
+            for (size_t i = first; i < last; ++i) {
+                auto [slot, team] = turn_order_[i];
+                intents_[i] = UnitDispatch::plan_turn(*store_.owner[slot], *this, team);
+            }
+        });
+    }
+    for (size_t i = 0; i < turn_order_.size(); ++i) {
+        auto [slot, team] = turn_order_[i];
+        if (store_.hp[slot] <= 0) {
+            continue;
         }
-        for (auto& dominant_for : school["dominant_for"]) {
-            vec_relations.push_back(dominant_for);
+        if (tick_mode_ == TWO_PHASE) {
+            UnitDispatch::apply_turn(*store_.owner[slot], *this, team, intents_[i]);
+        } else {
+            UnitDispatch::make_turn(*store_.owner[slot], *this, team);
         }
-        School sch(school["name"], vec_skills, vec_relations);
-        school_map[sch.name] = sch;
     }
-    return SchoolsTable(school_map);
+    last_tick_allocations_ = pool_->allocations() - allocations;
+    last_tick_heap_allocations_ = pool_->heap_allocations() - heap_allocations;
+    remove_dead();
+    if (autosaver_ != nullptr && autosaver_->due(ticks_)) {
+        autosaver_->submit(ticks_, std::make_shared<const SaveSnapshot>(take_snapshot()));
+    }
+}
+
+std::shared_ptr<const SchoolsTable> Game::read_schools_table(const std::string& units_dir, const std::string& skills_dir, const std::string& schools_dir, CatalogReport* report) {
+#ifdef SUMMONERS_BUILTIN_CATALOG
+    if (report != nullptr) {
+        *report = CatalogReport{};
+    }
+    return BuiltinCatalog::schools_table();
+#else
+    return CatalogFile::load(units_dir, skills_dir, schools_dir, report);
+#endif
+}
+
+std::shared_ptr<const SchoolsTable> Game::catalog() {
+    if (own_schools_table_ != nullptr) {
+        own_schools_table_->refresh_catalog();
+    }
+    return schools_table_;
+}
+
+SchoolsTable& Game::edit_schools_table() {
+    // Кроме own_schools_table_ и schools_table_ на собственную копию никто не ссылается
+    if (own_schools_table_ == nullptr || own_schools_table_.use_count() > 2) {
+        own_schools_table_ = std::make_shared<SchoolsTable>(*schools_table_);
+        schools_table_ = own_schools_table_;
+    }
+    return *own_schools_table_;
 }
 
 std::shared_ptr<Summoner> Game::read_summoner_(const std::string& summoner_path, Team team) {
+    int x = team == PLAYER ? std::min(10, field_width() - 1) : std::max(field_width() - 10, 0);
+#ifdef SUMMONERS_BUILTIN_CATALOG
+    if (auto builtin = BuiltinCatalog::summoner(std::filesystem::path(summoner_path).filename().string(), team)) {
+        return std::make_shared<Summoner>(x, field_height() / 2, *builtin);
+    }
+#endif
     std::ifstream summoner_file(summoner_path);
     json summoner = json::parse(summoner_file);
-    std::unordered_map<std::string, double> schools_knowledge;
+    std::unordered_map<Symbol, double> schools_knowledge;
     for (auto& school : summoner["schools_knowledge"]) {
-        schools_knowledge[school[0]] = school[1];
+        schools_knowledge[school[0].get<std::string>()] = school[1];
     }
     SummonerDescriptor descriptor(team, summoner["name"], summoner["initiative"], summoner["damage"], summoner["max_hp"], summoner["accumulation_coefficient"], summoner["max_energy"], schools_knowledge);
-    return std::make_shared<Summoner>(team == PLAYER ? 10 : FIELD_WEIGHT - 10, FIELD_HEIGHT / 2, descriptor);
+    return std::make_shared<Summoner>(x, field_height() / 2, descriptor);
 }
 
-Matrix<GameCell, FIELD_WEIGHT, FIELD_HEIGHT> Game::read_field_(const std::string& field_path) {
-    Matrix<GameCell, FIELD_WEIGHT, FIELD_HEIGHT> field;
-    field.fill(LAND);
+Grid<GameCell> Game::read_field_(const std::string& field_path) {
     std::ifstream field_file(field_path);
     json field_json = json::parse(field_file);
+    Grid<GameCell> field(field_json.value("width", DEFAULT_FIELD_WIDTH), field_json.value("height", DEFAULT_FIELD_HEIGHT), LAND);
     for (auto& point : field_json["obstacles"]) {
         field.at(point[0], point[1]) = OBSTACLE;
     }
@@ -174,102 +429,288 @@ Matrix<GameCell, FIELD_WEIGHT, FIELD_HEIGHT> Game::read_field_(const std::string
 }
 
 void Game::write_save(const std::string& save_path) {
-    std::ofstream save(save_path);
-    save << "{\"units\":[";
-    for (auto unit : player_units_) {
-        save << "{\"type\":";
-        if (typeid(*unit) == typeid(Summoner)) {
-            save << "\"Summoner\",";
-            save << "\"xp\":" << static_pointer_cast<Summoner>(unit)->characteristics().left_XP << ",";
-        } else if (typeid(*unit) == typeid(RessurectionUnit)) {
-            save << "\"Ressurection\",";
-        } else if (typeid(*unit) == typeid(AmoralUnit)) {
-            save << "\"Amoral\",";
-        } else if (typeid(*unit) == typeid(MoralUnit)) {
-            save << "\"Moral\",";
-        } else if (typeid(*unit) == typeid(Kamikaze)) {
-            save << "\"Kamikaze\","; 
+    json units = json::array();
+    for (Team team : {PLAYER, ENEMY}) {
+        for (const auto& unit : team == PLAYER ? player_units_ : enemy_units_) {
+            json record{{"type", UnitDispatch::kind_name(unit->kind())}, {"name", unit->name()}, {"hp", unit->current_HP()}, {"team", team == PLAYER ? "player" : "enemy"}, {"x", unit->x()}, {"y", unit->y()}};
+            if (unit->kind() == SUMMONER) {
+                record["xp"] = static_pointer_cast<Summoner>(unit)->characteristics().left_XP;
+            }
+            units.push_back(std::move(record));
         }
-        save << "\"name\":" << "\"" << unit->name() << "\",";
-        save << "\"hp\":" << unit->current_HP() << ",";
-        save << "\"team\":" << "\"player\"" << ",";
-        save << "\"x\":" << unit->x() << ",";
-        save << "\"y\":" << unit->y() << "},";
-    }
-    for (auto unit : enemy_units_) {
-        save << "{\"type\":";
-        if (typeid(*unit) == typeid(Summoner)) {
-            save << "\"Summoner\",";
-            save << "\"xp\":" << static_pointer_cast<Summoner>(unit)->characteristics().left_XP << ",";
-        } else if (typeid(*unit) == typeid(RessurectionUnit)) {
-            save << "\"Ressurection\",";
-        } else if (typeid(*unit) == typeid(AmoralUnit)) {
-            save << "\"Amoral\",";
-        } else if (typeid(*unit) == typeid(MoralUnit)){
-            save << "\"Moral\",";
-        } else if (typeid(*unit) == typeid(Kamikaze)) {
-            save << "\"Kamikaze\",";
+    }
+    std::string save = json{{"units", std::move(units)}}.dump();
+    BinaryWriter::write_atomically(save_path, save.data(), save.size());
+}
+
+UnitTemplate Game::find_template_(const std::string& name, const std::string& units_dir, std::unordered_map<std::string, UnitTemplate>& loaded) const {
+    // Шаблоны берутся из каталога игры; JSON отрядов читается, только если в каталоге их нет
+    UnitTemplate unit = schools_table_->find_unit(name);
+    if (unit) {
+        return unit;
+    }
+    if (loaded.empty()) {
+        for (const auto& descriptor : CatalogFile::read_units(units_dir)) {
+            loaded[descriptor.name] = descriptor;
         }
-        save << "\"name\":" << "\"" << unit->name() << "\",";
-        save << "\"hp\":" << unit->current_HP() << ",";
-        save << "\"team\":" << "\"enemy\"" << ",";
-        save << "\"x\":" << unit->x() << ",";
-        save << "\"y\":" << unit->y() << "},";
     }
-    save.seekp(static_cast<long>(save.tellp()) - 1);
-    save << "]}";
+    return loaded.at(name);
+}
+
+namespace {
+    /**
+    * \brief Юнит сохранения в JSON.
+    */
+    struct SaveRecord {
+        std::string type;
+        std::string name;
+        std::string team;
+        double hp = 0;
+        double xp = 0;
+        int x = 0;
+        int y = 0;
+    };
+
+    /**
+    * \brief Потоковый разбор сохранения: запись юнита передаётся дальше, как только закрыта её скобка.
+    *
+    * Дерево документа не строится, поэтому память не зависит от числа юнитов.
+    * Неизвестные поля, в том числе вложенные, пропускаются.
+    */
+    class SaveReader : public json::json_sax_t {
+        public:
+            explicit SaveReader(std::function<void(const SaveRecord&)> on_record) : on_record_(std::move(on_record)) {}
+            const std::string& error() const { return error_; }
+            bool null() override { return true; }
+            bool boolean(bool) override { return true; }
+            bool number_integer(number_integer_t value) override { return number_(value); }
+            bool number_unsigned(number_unsigned_t value) override { return number_(value); }
+            bool number_float(number_float_t value, const string_t&) override { return number_(value); }
+            bool string(string_t& value) override {
+                if (in_record_()) {
+                    if (key_ == "type") {
+                        record_.type = std::move(value);
+                    } else if (key_ == "name") {
+                        record_.name = std::move(value);
+                    } else if (key_ == "team") {
+                        record_.team = std::move(value);
+                    }
+                }
+                return true;
+            }
+            bool binary(binary_t&) override { return true; }
+            bool start_object(std::size_t) override {
+                if (++depth_ == 3 && in_units_) {
+                    record_ = SaveRecord{};
+                }
+                return true;
+            }
+            bool end_object() override {
+                if (in_record_()) {
+                    on_record_(record_);
+                }
+                --depth_;
+                return true;
+            }
+            bool start_array(std::size_t) override {
+                if (++depth_ == 2 && key_ == "units") {
+                    in_units_ = true;
+                }
+                return true;
+            }
+            bool end_array() override {
+                if (depth_-- == 2) {
+                    in_units_ = false;
+                }
+                return true;
+            }
+            bool key(string_t& key) override {
+                key_ = std::move(key);
+                return true;
+            }
+            bool parse_error(std::size_t, const std::string&, const nlohmann::detail::exception& e) override {
+                error_ = e.what();
+                return false;
+            }
+        private:
+            std::function<void(const SaveRecord&)> on_record_;
+            SaveRecord record_;
+            std::string key_;
+            std::string error_;
+            int depth_ = 0;             ///< Глубина вложенности объектов и массивов
+            bool in_units_ = false;
+            bool in_record_() const { return in_units_ && depth_ == 3; }
+            bool number_(double value) {
+                if (in_record_()) {
+                    if (key_ == "hp") {
+                        record_.hp = value;
+                    } else if (key_ == "xp") {
+                        record_.xp = value;
+                    } else if (key_ == "x") {
+                        record_.x = value;
+                    } else if (key_ == "y") {
+                        record_.y = value;
+                    }
+                }
+                return true;
+            }
+    };
 }
 
 void Game::read_save(const std::string& save_path, const std::string& units_dir) {
-    std::unordered_map<std::string, UnitDescriptor> unit_map;
-    for (const auto& unit_json : std::filesystem::directory_iterator(units_dir)) {
-        std::ifstream json_file(unit_json.path());
-        json unit = json::parse(json_file);
-        std::optional<double> morality = std::nullopt;
-        if (unit["morality"] != "NULL") {
-            morality = unit["morality"];
-        } else {
-            morality = std::nullopt;
+    std::unordered_map<std::string, UnitTemplate> unit_map;
+    SaveReader reader([&](const SaveRecord& unit) {
+        Team team = unit.team == "player" ? PLAYER : ENEMY;
+        if (unit.type == UnitDispatch::kind_name(SUMMONER)) {
+            auto& summoner = team == PLAYER ? teammates()[0] : enemies()[0];
+            summoner->current_HP() = unit.hp;
+            if (summoner->x() != unit.x || summoner->y() != unit.y) {
+                move_unit(*summoner, unit.x, unit.y);
+            }
+            static_pointer_cast<Summoner>(summoner)->characteristics().left_XP = unit.xp;
+            return;
         }
-        UnitDescriptor ud(unit["name"], unit["school"], unit["initiative"], unit["max_amount"], unit["damage"], unit["entity_hp"], unit["speed"], unit["defence"], unit["xp_for_destroy"], morality);
-        unit_map[ud.name] = ud;
-    }
+        std::optional<UnitKind> kind;
+        for (UnitKind candidate : {MORAL, AMORAL, RESSURECTION, KAMIKAZE}) {
+            if (unit.type == UnitDispatch::kind_name(candidate)) {
+                kind = candidate;
+            }
+        }
+        if (!kind) {
+            throw std::runtime_error("Unknown unit type " + unit.type);
+        }
+        auto unit_ptr = Factory::creator(*kind)(find_template_(unit.name, units_dir, unit_map), pool_);
+        unit_ptr->current_HP() = unit.hp;
+        static_pointer_cast<RealUnit>(unit_ptr)->update_amount();
+        deploy_unit(unit.x, unit.y, unit_ptr, team);
+    });
     std::ifstream save_file(save_path);
-    json save = json::parse(save_file);
-    for (auto& unit : save["units"]) {
-        std::shared_ptr<BaseUnit> unit_ptr;
-        if (unit["type"] == "Moral") {
-            unit_ptr = Factory::create_moral_unit(unit_map[unit["name"]]);
-        } else if (unit["type"] == "Amoral") {
-            unit_ptr = Factory::create_amoral_unit(unit_map[unit["name"]]);
-        } else if (unit["type"] == "Ressurection") {
-            unit_ptr = Factory::create_ressurection_unit(unit_map[unit["name"]]);
-        } else if (unit["type"] == "Summoner"){
-            double xp = unit["xp"];
-            unit["team"] == "player" ? teammates()[0]->current_HP() = unit["hp"] : enemies()[0]->current_HP() = unit["hp"];
-            unit["team"] == "player" ? teammates()[0]->x() = unit["x"] : enemies()[0]->x() = unit["x"];
-            unit["team"] == "player" ? teammates()[0]->y() = unit["y"] : enemies()[0]->y() = unit["y"];
-            unit["team"] == "player" ? static_pointer_cast<Summoner>(teammates()[0])->characteristics().left_XP = xp : static_pointer_cast<Summoner>(enemies()[0])->characteristics().left_XP = xp;
+    if (!save_file) {
+        throw std::runtime_error("Can't open " + save_path);
+    }
+    if (!json::sax_parse(save_file, &reader)) {
+        throw std::runtime_error("Save " + save_path + " is damaged: " + reader.error());
+    }
+}
+
+SaveSnapshot Game::take_snapshot() {
+    SaveSnapshot snapshot;
+    SaveHeader& header = snapshot.header;
+    header.ticks = ticks_;
+    header.rng_key = rng_.key();
+    header.rng_counter = rng_.counter();
+    header.xp_to_collect = xp_to_collect_;
+    header.winner = winner_ ? static_cast<int32_t>(*winner_) : -1;
+    StringTable& strings = snapshot.strings;
+    std::vector<SaveUnit>& units = snapshot.units;
+    std::vector<SaveKnowledge>& knowledge = snapshot.knowledge;
+    units.reserve(player_units_.size() + enemy_units_.size());
+    for (Team team : {PLAYER, ENEMY}) {
+        for (const auto& unit : team == PLAYER ? player_units_ : enemy_units_) {
+            SaveUnit record{};
+            record.name = strings.add(unit->name());
+            record.kind = unit->kind();
+            record.team = team;
+            record.x = unit->x();
+            record.y = unit->y();
+            record.amount = unit->amount();
+            record.current_HP = unit->current_HP();
+            record.initiative = unit->initiative();
+            BaseUnit* inner = unit->kind() == RESSURECTION ? static_cast<RessurectionUnit&>(*unit).unit().get() : unit.get();
+            if (inner->kind() == MORAL) {
+                record.has_morality = 1;
+                record.morality = static_cast<MoralUnit&>(*inner).morality();
+            }
+            if (unit->kind() == SUMMONER) {
+                const auto& characteristics = static_cast<Summoner&>(*unit).characteristics();
+                record.first_knowledge = knowledge.size();
+                for (const auto& [school, value] : characteristics.schools_knowledge) {
+                    knowledge.push_back({strings.add(school.name()), 0, value});
+                }
+                record.knowledge = knowledge.size() - record.first_knowledge;
+                record.damage = characteristics.damage;
+                record.max_HP = characteristics.max_HP;
+                record.accumulation_coefficient = characteristics.accumulation_coefficient;
+                record.left_XP = characteristics.left_XP;
+                record.max_energy = characteristics.max_energy;
+                record.current_energy = characteristics.current_energy;
+            }
+            units.push_back(record);
+        }
+    }
+    return snapshot;
+}
+
+void Game::write_snapshot(const std::string& path, bool sync) {
+    SaveFile::write(path, take_snapshot(), sync);
+}
+
+void Game::read_snapshot(const std::string& path, const std::string& units_dir) {
+    SaveFile save(path);
+    const SaveHeader& header = save.header();
+    std::unordered_map<std::string, UnitTemplate> unit_map;
+    for (const SaveUnit& record : save.units()) {
+        Team team = static_cast<Team>(record.team);
+        std::string name(save.string(record.name));
+        if (record.kind == SUMMONER) {
+            std::unordered_map<Symbol, double> schools_knowledge;
+            for (const auto& knowledge : save.knowledge().subspan(record.first_knowledge, record.knowledge)) {
+                schools_knowledge[save.string(knowledge.school)] = knowledge.knowledge;
+            }
+            SummonerDescriptor descriptor(team, name, record.initiative, record.damage, record.max_HP, record.accumulation_coefficient, record.max_energy, schools_knowledge);
+            descriptor.left_XP = record.left_XP;
+            descriptor.current_energy = record.current_energy;
+            descriptor.current_HP = record.current_HP;
+            auto& units = team == PLAYER ? player_units_ : enemy_units_;
+            if (units.empty() || units.front()->kind() != SUMMONER) {
+                deploy_unit(record.x, record.y, std::make_shared<Summoner>(record.x, record.y, descriptor), team);
+                continue;
+            }
+            auto summoner = static_pointer_cast<Summoner>(units.front());
+            if (summoner->x() != record.x || summoner->y() != record.y) {
+                move_unit(*summoner, record.x, record.y);
+            }
+            summoner->characteristics() = descriptor;
+            summoner->current_HP() = record.current_HP;
+            summoner->initiative() = record.initiative;
             continue;
         }
-        unit_ptr->current_HP() = unit["hp"];
-        static_pointer_cast<RealUnit>(unit_ptr)->update_amount();
-        deploy_unit(unit["x"], unit["y"], unit_ptr, unit["team"] == "player" ? PLAYER : ENEMY);
+        auto unit = Factory::creator(static_cast<UnitKind>(record.kind))(find_template_(name, units_dir, unit_map), pool_);
+        unit->current_HP() = record.current_HP;
+        unit->amount() = record.amount;
+        unit->initiative() = record.initiative;
+        if (record.has_morality) {
+            BaseUnit* inner = record.kind == RESSURECTION ? static_cast<RessurectionUnit&>(*unit).unit().get() : unit.get();
+            if (inner->kind() == MORAL) {
+                static_cast<MoralUnit&>(*inner).morality() = record.morality;
+            }
+        }
+        deploy_unit(record.x, record.y, unit, team);
     }
+    ticks_ = header.ticks;
+    rng_ = RandomStream(header.rng_key, header.rng_counter);
+    xp_to_collect_ = header.xp_to_collect;
+    winner_ = header.winner < 0 ? std::nullopt : std::optional<Team>(static_cast<Team>(header.winner));
 }
 
 Game::Game(const std::string& units_dir, const std::string& skills_dir, const std::string& schools_dir, const std::string& player_summoner_path, const std::string& enemy_summoner_path, const std::string& field_path) {
     field_ = read_field_(field_path);
-    schools_table_ = read_schools_table_(units_dir, skills_dir, schools_dir);
-    player_units_ = {read_summoner_(player_summoner_path, PLAYER)};
-    enemy_units_ = {read_summoner_(enemy_summoner_path, ENEMY)};
+    reset_layers_();
+    schools_table_ = read_schools_table(units_dir, skills_dir, schools_dir, &catalog_report_);
+    auto player = read_summoner_(player_summoner_path, PLAYER);
+    auto enemy = read_summoner_(enemy_summoner_path, ENEMY);
+    deploy_unit(player->x(), player->y(), player, PLAYER);
+    deploy_unit(enemy->x(), enemy->y(), enemy, ENEMY);
 }
 
 Game::Game(const std::string& units_dir, const std::string& skills_dir, const std::string& schools_dir, const std::string& player_summoner_path, const std::string& enemy_summoner_path, const std::string& field_path, const std::string& save_path) {
     field_ = read_field_(field_path);
-    schools_table_ = read_schools_table_(units_dir, skills_dir, schools_dir);
-    player_units_ = {read_summoner_(player_summoner_path, PLAYER)};
-    enemy_units_ = {read_summoner_(enemy_summoner_path, ENEMY)};
+    reset_layers_();
+    schools_table_ = read_schools_table(units_dir, skills_dir, schools_dir, &catalog_report_);
+    auto player = read_summoner_(player_summoner_path, PLAYER);
+    auto enemy = read_summoner_(enemy_summoner_path, ENEMY);
+    deploy_unit(player->x(), player->y(), player, PLAYER);
+    deploy_unit(enemy->x(), enemy->y(), enemy, ENEMY);
     read_save(save_path, units_dir);
 }
 
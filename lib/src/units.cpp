@@ -1,49 +1,83 @@
 #include "../include/game.hpp"
+#include "../include/UnitDispatch.hpp"
+#include <algorithm>
+#include <atomic>
 #include <cmath>
 #include <limits>
 #include <random>
-#include <thread>
 
 void BaseUnit::death(Game& game) {
     current_HP() = 0;
 }
 
+void BaseUnit::bind(UnitStore* store, uint32_t slot) {
+    store->x[slot] = x();
+    store->y[slot] = y();
+    store->hp[slot] = current_HP();
+    store->amount[slot] = amount();
+    store->initiative[slot] = initiative();
+    store_ = store;
+    slot_ = slot;
+}
+
+void BaseUnit::unbind() {
+    if (store_ == nullptr) {
+        return;
+    }
+    UnitStore* store = store_;
+    store_ = nullptr;
+    x() = store->x[slot_];
+    y() = store->y[slot_];
+    current_HP() = store->hp[slot_];
+    amount() = store->amount[slot_];
+    initiative() = store->initiative[slot_];
+    slot_ = UnitStore::no_slot;
+}
+
+static double subtract_hp(double& hp, double damage) {
+    return std::atomic_ref<double>(hp).fetch_sub(damage) - damage;
+}
+
+static void lower_amount(int& amount, int bound) {
+    std::atomic_ref<int> ref(amount);
+    int current = ref.load();
+    while (bound < current && !ref.compare_exchange_weak(current, bound)) {}
+}
+
+static void shift_morality(double& morality, double delta) {
+    std::atomic_ref<double> ref(morality);
+    double current = ref.load();
+    while (!ref.compare_exchange_weak(current, std::clamp(current + delta, MIN_MORALITY, MAX_MORALITY))) {}
+}
+
 void RealUnit::move(Game& game, int x_pos, int y_pos) {
+    if (auto moved = RealUnit::try_move(game, x_pos, y_pos); !moved) {
+        throw std::invalid_argument(describe(moved.error()));
+    }
+}
+
+Expected<void> RealUnit::try_move(Game& game, int x_pos, int y_pos) {
     if (abs(x() - x_pos) > characteristics().speed || abs(y() - y_pos) > characteristics().speed) {
-        throw std::invalid_argument("Your speed is not enough!");
-    } else if (!game.is_avialable(x_pos, y_pos)) {
-        throw std::invalid_argument("This cell is unavialable");
-    } else {
-        x() = x_pos;
-        y() = y_pos;
+        return Unexpected(TOO_FAR);
     }
+    return game.try_move_unit(*this, x_pos, y_pos);
 }
 
 void RealUnit::update_amount() {
-    characteristics().amount = std::ceil(current_HP() / characteristics().entity_HP);
+    amount() = std::ceil(current_HP() / characteristics().entity_HP);
 }
 
 void RealUnit::take_damage(double damage) {
-    current_HP() = current_HP() - damage;
-    update_amount();
-}
-
-double RealUnit::damage_coefficient(SchoolsTable& table, unit_t enemy) {
-    double coefficient = 1.0;
-    if (RealUnit* real_unit = dynamic_cast<RealUnit*>(enemy.get())) {
-        const School& school = table.get_school(characteristics().school);
-        const School& other_school = table.get_school(real_unit->characteristics().school);
-        if (school > other_school) {
-            coefficient = 1.2;
-        } else if (other_school > school) {
-            coefficient = 0.8;
-        }
-    }
-    return coefficient;
+    double hp = subtract_hp(current_HP(), damage);
+    lower_amount(amount(), std::ceil(hp / characteristics().entity_HP));
+}
+
+double RealUnit::damage_coefficient(const SchoolsTable& table, unit_t enemy) {
+    return table.coefficient(characteristics().school, enemy->school());
 }
 
 void RealUnit::make_damage(Game& game, unit_t enemy) {
-    enemy->take_damage(enemy->damage_coefficient(game.schools_table(), enemy) * damage());
+    UnitDispatch::take_damage(*enemy, damage_coefficient(game.schools_table(), enemy) * damage());
     if (enemy->current_HP() <= 0) {
         enemy->death(game);
     }
@@ -54,39 +88,67 @@ void RealUnit::make_turn(Game& game, Team self_team) {
         return;
     }
     unit_t closest_enemy = game.find_closest_enemy(x(), y(), self_team);
-    try {
-        if (abs(x() - closest_enemy->x()) > characteristics().speed * 2) {
-            if (x() - closest_enemy->x() < 0) {
-                move(game, x() + characteristics().speed > FIELD_WEIGHT ? FIELD_WEIGHT - 1 : x() + characteristics().speed, y());
-            } else {
-                move(game, x() - characteristics().speed < 0 ? 0 : x() - characteristics().speed, y());
-            }
-            return;
-        } else if (abs(y() - closest_enemy->y()) > characteristics().speed * 2) {
-            if (y() - closest_enemy->y() < 0) {
-                move(game, x(), y() + characteristics().speed > FIELD_HEIGHT ? FIELD_HEIGHT - 1 : y() + characteristics().speed);
-            } else {
-                move(game, x(), y() - characteristics().speed < 0 ? 0 : y() - characteristics().speed);
-            }
-            return;
-        } 
-        make_damage(game, closest_enemy);
-    } 
-    catch (std::invalid_argument& e) {
-        for (int i = 0; i <= characteristics().speed; ++i) {
-            for (int j = 0; j <= characteristics().speed; ++j) {
-                if (i == 0 && j == 0) { continue; }
-                if (game.is_avialable(x() + i, y() + j)) {
-                    move(game, x() + i, y() + j);
-                    return;
-                } else if (game.is_avialable(x() - i, y() - j)) {
-                    move(game, x() - i, y() - j);
-                    return;
-                }
-            }
+    if (closest_enemy == nullptr) {
+        return;
+    }
+    int speed = characteristics().speed;
+    if (abs(x() - closest_enemy->x()) > speed * 2 || abs(y() - closest_enemy->y()) > speed * 2) {
+        game.update_paths(self_team);
+        auto [to_x, to_y] = game.path_step(x(), y(), self_team, speed);
+        if (to_x != x() || to_y != y()) {
+            game.try_move_unit(*this, to_x, to_y);
         }
         return;
     }
+    UnitDispatch::make_damage(*this, game, closest_enemy);
+}
+
+Intent RealUnit::plan_turn(Game& game, Team self_team) {
+    Intent intent;
+    intent.action = Intent::IDLE;
+    if (current_HP() <= 0) {
+        return intent;
+    }
+    uint32_t target = game.closest_enemy_slot(x(), y(), self_team);
+    if (target == UnitStore::no_slot) {
+        return intent;
+    }
+    const UnitStore& store = game.store();
+    int speed = characteristics().speed;
+    if (abs(x() - store.x[target]) > speed * 2 || abs(y() - store.y[target]) > speed * 2) {
+        std::tie(intent.x, intent.y) = game.path_step(x(), y(), self_team, speed);
+        if (intent.x != x() || intent.y != y()) {
+            intent.action = Intent::MOVE;
+        }
+    } else {
+        intent.action = Intent::ATTACK;
+        intent.target = target;
+    }
+    return intent;
+}
+
+void RealUnit::apply_turn(Game& game, Team self_team, const Intent& intent) {
+    if (current_HP() <= 0) {
+        return;
+    }
+    const UnitStore& store = game.store();
+    if (intent.action == Intent::MOVE) {
+        if (!game.try_move_unit(*this, intent.x, intent.y)) {
+            RealUnit::make_turn(game, self_team);
+        }
+    } else if (intent.action == Intent::ATTACK && store.alive(intent.target)) {
+        UnitDispatch::make_damage(*this, game, store.owner[intent.target]->shared_from_this());
+    } else if (intent.action != Intent::IDLE) {
+        RealUnit::make_turn(game, self_team);
+    }
+}
+
+void MoralUnit::apply_turn(Game& game, Team self_team, const Intent& intent) {
+    if (current_HP() <= 0) {
+        return;
+    }
+    RealUnit::apply_turn(game, self_team, intent);
+    MoralUnit::balance_morality();
 }
 
 void MoralUnit::make_turn(Game& game, Team self_team) {
@@ -94,35 +156,27 @@ void MoralUnit::make_turn(Game& game, Team self_team) {
         return;
     }
     RealUnit::make_turn(game, self_team);
-    balance_morality();
+    MoralUnit::balance_morality();
 }
 
 void MoralUnit::increase_morality(double morality) {
-    if (characteristics().morality.value() + morality >= MAX_MORALITY) {
-        characteristics().morality = MAX_MORALITY;
-    } else {
-        characteristics().morality = characteristics().morality.value() + morality;
-    }
+    shift_morality(morality_, morality);
 }
 
 void MoralUnit::decrease_morality(double morality) {
-    if (characteristics().morality.value() - morality <= MIN_MORALITY) {
-        characteristics().morality = MIN_MORALITY;
-    } else {
-        characteristics().morality = characteristics().morality.value() - morality;
-    }
+    shift_morality(morality_, -morality);
 }
 
 void MoralUnit::balance_morality() {
-    if (characteristics().morality.value() < 0) {
-        if (characteristics().morality.value() + 0.05 > 0) {
-            characteristics().morality = 0;
+    if (morality_ < 0) {
+        if (morality_ + 0.05 > 0) {
+            morality_ = 0;
         } else {
             increase_morality(0.05);
         }
-    } else if (characteristics().morality.value() > 0) {
-        if (characteristics().morality.value() - 0.05 < 0) {
-            characteristics().morality = 0;
+    } else if (morality_ > 0) {
+        if (morality_ - 0.05 < 0) {
+            morality_ = 0;
         } else {
             decrease_morality(0.05);
         }
@@ -130,7 +184,7 @@ void MoralUnit::balance_morality() {
 }
 
 void MoralUnit::make_damage(Game& game, unit_t enemy) {
-    enemy->take_damage(damage_coefficient(game.schools_table(), enemy) * (1.0 + characteristics().morality.value()) * damage());
+    UnitDispatch::take_damage(*enemy, damage_coefficient(game.schools_table(), enemy) * (1.0 + morality_) * damage());
     if (enemy->current_HP() <= 0) {
         enemy->death(game);
         increase_morality(0.25);
@@ -138,38 +192,56 @@ void MoralUnit::make_damage(Game& game, unit_t enemy) {
 }
 
 void MoralUnit::take_damage(double damage) {
-    current_HP() = current_HP() - damage;
-    int temp_amount = characteristics().amount;
-    update_amount();
-    decrease_morality((temp_amount - characteristics().amount) * 0.01);
+    double hp = subtract_hp(current_HP(), damage);
+    int lost = std::ceil((hp + damage) / characteristics().entity_HP) - std::ceil(hp / characteristics().entity_HP);
+    lower_amount(amount(), std::ceil(hp / characteristics().entity_HP));
+    decrease_morality(lost * 0.01);
 }
 
 void RessurectionUnit::make_turn(Game& game, Team self_team) {
     if (current_HP() <= 0) {
         return;
     }
-    if (characteristics().amount < characteristics().max_amount) {
-        try_to_ressurect();
+    if (amount() < characteristics().max_amount) {
+        RandomStream stream = game.stream(slot());
+        try_to_ressurect(stream);
     }
-    unit_->make_turn(game, self_team);
+    UnitDispatch::make_turn(*unit_, game, self_team);
+}
+
+Intent RessurectionUnit::plan_turn(Game& game, Team self_team) {
+    return UnitDispatch::plan_turn(*unit_, game, self_team);
+}
+
+void RessurectionUnit::apply_turn(Game& game, Team self_team, const Intent& intent) {
+    if (current_HP() <= 0) {
+        return;
+    }
+    if (amount() < characteristics().max_amount) {
+        RandomStream stream = game.stream(slot());
+        try_to_ressurect(stream);
+    }
+    UnitDispatch::apply_turn(*unit_, game, self_team, intent);
+}
+
+void RessurectionUnit::take_damage(double damage) {
+    UnitDispatch::take_damage(*unit_, damage);
 }
 
-void RessurectionUnit::try_to_ressurect() {
-    std::random_device rd{};
-    std::mt19937 gen{rd()};
-    try_to_ressurect(gen);
+void RessurectionUnit::make_damage(Game& game, unit_t enemy) {
+    UnitDispatch::make_damage(*unit_, game, std::move(enemy));
 }
 
-void RessurectionUnit::try_to_ressurect(std::mt19937 gen) {
-    std::geometric_distribution<> d;
-    int dead = characteristics().max_amount - characteristics().amount;
-    int to_be_ressurected = 0;
-    if (dead != 0) {
-        do {
-            to_be_ressurected = std::round(d(gen));
-        } while (to_be_ressurected > (characteristics().max_amount - characteristics().amount));
+void RessurectionUnit::ressurect_(double uniform) {
+    const double p = 0.5;
+    int dead = characteristics().max_amount - amount();
+    if (dead <= 0) {
+        return;
     }
-    characteristics().amount += to_be_ressurected;
+    double tail = 1.0 - std::pow(1.0 - p, dead + 1);
+    int to_be_ressurected = std::floor(std::log1p(-uniform * tail) / std::log1p(-p));
+    to_be_ressurected = std::clamp(to_be_ressurected, 0, dead);
+    amount() += to_be_ressurected;
     current_HP() += characteristics().entity_HP * to_be_ressurected;
 }
 
@@ -178,32 +250,32 @@ void Summoner::make_turn(Game& game, Team self_team) {
         return;
     }
     characteristics().left_XP += game.get_xp();
-    if (self_team == PLAYER) {
+    if (self_team == PLAYER && game.interactive()) {
         game.players_turn(*this);
         return;
     }
-    std::tuple<std::string, std::string, double> preferable = {"NULL", "NULL", 0};
-    for (auto school : characteristics().schools_knowledge) {
-        for (auto skill : game.schools_table().get_school(school.first).skills) {
-            if (skill.characteristics.damage >= get<double>(preferable) && characteristics().current_energy >= skill.required_energy && school.second >= skill.min_knowledge) {
-                get<0>(preferable) = skill.characteristics.school;
-                get<1>(preferable) = skill.name;
-                get<double>(preferable) = skill.characteristics.damage;
-            }
+    if (game.closest_enemy_slot(x(), y(), self_team) == UnitStore::no_slot) {
+        accumulate_energy();
+        return;
+    }
+    const Skill* preferable = nullptr;
+    for (auto& [school_name, knowledge] : characteristics().schools_knowledge) {
+        const Skill* skill = game.schools_table().best_skill(school_name, characteristics().current_energy, knowledge);
+        if (skill != nullptr && (preferable == nullptr || skill->characteristics.damage >= preferable->characteristics.damage)) {
+            preferable = skill;
         }
     }
-    if (get<0>(preferable) == "NULL") {
+    if (preferable == nullptr) {
         accumulate_energy();
         return;
     }
+    Symbol school_name = preferable->characteristics.school;
+    Symbol skill_name = preferable->name;
     for (int i = 0; i <= 1; ++i) {
         for (int j = 0; j <= 1; ++j) {
             if (i == 0 && j == 0) { continue; }
-            if (game.is_avialable(x() + i, y() + j)) {
-                summon_unit(game, get<0>(preferable), get<1>(preferable), x() + i, y() + j);
-                return;
-            } else if (game.is_avialable(x() - i, y() - j)) {
-                summon_unit(game, get<0>(preferable), get<1>(preferable), x() - i, y() - j);
+            if (try_summon_unit(game, school_name, skill_name, x() + i, y() + j)
+                || try_summon_unit(game, school_name, skill_name, x() - i, y() - j)) {
                 return;
             }
         }
@@ -211,20 +283,13 @@ void Summoner::make_turn(Game& game, Team self_team) {
 }
 
 void Kamikaze::damage_all_enemies(Game& game, Team self_team) {
-    size_t threads_amount = std::thread::hardware_concurrency() == 0 ? 12 : std::thread::hardware_concurrency();
-    std::vector<std::thread> threads(threads_amount);
-    size_t enemies_amount = self_team == PLAYER ? game.enemies().size() : game.teammates().size();
     const auto& enemies = self_team == PLAYER ? game.enemies() : game.teammates();
-    for (size_t i = 0; i < threads_amount; ++i) {
-        size_t start_i = i * enemies_amount / threads_amount;
-        size_t end_i = std::min((i + 1) * enemies_amount / threads_amount, enemies_amount);
-        auto start = std::next(enemies.begin(), start_i);
-        auto end = std::next(enemies.begin(), end_i);
-        threads[i] = std::thread([&, start, end](){ for (auto j = start; j < end; ++j) { (*j)->take_damage(damage()); } });
-    }
-    for (auto& thread : threads) {
-        thread.join();
-    }
+    double kamikaze_damage = damage();
+    game.scheduler().parallel_for(0, enemies.size(), 64, [&](size_t first, size_t last) {
+        for (size_t i = first; i < last; ++i) {
+            UnitDispatch::take_damage(*enemies[i], kamikaze_damage);
+        }
+    });
 }
 
 void Kamikaze::make_turn(Game& game, Team self_team) {
@@ -245,18 +310,37 @@ void Summoner::accumulate_energy() {
     }
 }
 
-void Summoner::summon_unit(Game& game, const std::string& school_name, const std::string& skill_name, size_t x, size_t y) {
-    Skill& skill = game.schools_table().get_skill(school_name, skill_name);
-    if (characteristics().schools_knowledge[skill.characteristics.school] < skill.min_knowledge) {
-        throw std::runtime_error("Knowledge of this school is not enough to use this skill!");
+void Summoner::summon_unit(Game& game, Symbol school_name, Symbol skill_name, size_t x, size_t y) {
+    auto summoned = try_summon_unit(game, school_name, skill_name, x, y);
+    if (!summoned) {
+        if (summoned.error() == NOT_ENOUGH_KNOWLEDGE || summoned.error() == NOT_ENOUGH_ENERGY) {
+            throw std::runtime_error(describe(summoned.error()));
+        }
+        throw std::invalid_argument(describe(summoned.error()));
+    }
+}
+
+Expected<void> Summoner::try_summon_unit(Game& game, Symbol school_name, Symbol skill_name, size_t x, size_t y) {
+    auto found = game.schools_table().find_skill(school_name, skill_name);
+    if (!found) {
+        return Unexpected(found.error());
+    }
+    const Skill& skill = **found;
+    auto known = characteristics().schools_knowledge.find(skill.characteristics.school);
+    double knowledge = known == characteristics().schools_knowledge.end() ? 0.0 : known->second;
+    if (knowledge < skill.min_knowledge) {
+        return Unexpected(NOT_ENOUGH_KNOWLEDGE);
     } else if (characteristics().current_energy < skill.required_energy) {
-        throw std::runtime_error("Your energy level is not enough to use this skill!");
+        return Unexpected(NOT_ENOUGH_ENERGY);
+    } else if (!game.is_avialable(x, y)) {
+        return Unexpected(CELL_UNAVIALABLE);
     }
-    game.deploy_unit(x, y, skill.create(skill.characteristics), characteristics().team);
+    game.try_deploy(x, y, skill.create(skill.unit, game.unit_pool()), characteristics().team);
     characteristics().current_energy -= skill.required_energy;
+    return {};
 }
 
-void Summoner::upgrade_school(std::string& school_name) {
+void Summoner::upgrade_school(Symbol school_name) {
     if (characteristics().left_XP < 50.0) {
         throw std::runtime_error("You haven't enough XP to upgrade!");
     }
@@ -264,27 +348,29 @@ void Summoner::upgrade_school(std::string& school_name) {
     characteristics().left_XP -= 50.0;
 }
 
-double Summoner::damage_coefficient(SchoolsTable& table, unit_t enemy) {
+double Summoner::damage_coefficient(const SchoolsTable& table, unit_t enemy) {
     return 1.0;
 }
 
 void Summoner::move(Game& game, int x_pos, int y_pos) {
+    if (auto moved = try_move(game, x_pos, y_pos); !moved) {
+        throw std::invalid_argument(moved.error() == TOO_FAR ? "You can't go to that cell!" : describe(moved.error()));
+    }
+}
+
+Expected<void> Summoner::try_move(Game& game, int x_pos, int y_pos) {
     if (abs(x() - x_pos) > 1 || abs(y() - y_pos) > 1) {
-        throw std::invalid_argument("You can't go to that cell!");
-    } else if (!game.is_avialable(x_pos, y_pos)) {
-        throw std::invalid_argument("This cell is unavialable");
-    } else {
-        x() = x_pos;
-        y() = y_pos;
+        return Unexpected(TOO_FAR);
     }
+    return game.try_move_unit(*this, x_pos, y_pos);
 }
 
 void Summoner::take_damage(double damage) {
-    current_HP() = current_HP() - damage;
+    subtract_hp(current_HP(), damage);
 }
 
 void Summoner::make_damage(Game& game, unit_t enemy) {
-    enemy->take_damage(damage());
+    UnitDispatch::take_damage(*enemy, damage());
     if (enemy->current_HP() <= 0) {
         enemy->death(game);
     }
@@ -1,9 +1,23 @@
 #define CATCH_CONFIG_MAIN
 
 #include <catch2/catch_all.hpp>
+#include <cstddef>
 #include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
 #include "../lib/include/game.hpp"
 #include "../lib/include/factory.hpp"
+#include "../lib/include/UnitDispatch.hpp"
+#include "../lib/include/BatchRunner.hpp"
+#include "../lib/include/CatalogFile.hpp"
+#include "../lib/include/SaveFile.hpp"
+#ifdef SUMMONERS_BUILTIN_CATALOG
+#include "../lib/include/BuiltinCatalog.hpp"
+#endif
+#include "../lib/include/FlowField.hpp"
+#include "../lib/include/PathHierarchy.hpp"
+#include "../lib/include/FieldComponents.hpp"
 
 TEST_CASE("Matrix") {
     SECTION("Constructors") {
@@ -25,6 +39,23 @@ TEST_CASE("Matrix") {
         Matrix robber(copy);
         REQUIRE(robber == matrix);
     }
+    SECTION("Grid") {
+        Grid<int> grid(2, 3, 7);
+        Grid<int> empty;
+        REQUIRE(grid.size() == 6);
+        REQUIRE((grid.rows() == 2 && grid.columns() == 3));
+        REQUIRE(grid.at(1, 2) == 7);
+        REQUIRE_THROWS(grid.at(2, 0));
+        REQUIRE(empty.empty());
+        grid.at(1, 2) = 1;
+        Grid copy(grid);
+        REQUIRE(copy == grid);
+        Grid moved(std::move(copy));
+        REQUIRE(moved(1, 2) == 1);
+        Matrix<int, 2, 2> matrix = {1, 0, 0, 1};
+        Grid<int> from_matrix(matrix);
+        REQUIRE((from_matrix.rows() == 2 && from_matrix.at(1, 1) == 1));
+    }
 }
 
 TEST_CASE("Game") {
@@ -33,7 +64,7 @@ TEST_CASE("Game") {
     SummonerDescriptor k_sd{PLAYER, "V.L. Kamynin", 1.0, 1.0, 999.0, 1.2, 10.0, {{"MSU", 100.0}}};
     UnitDescriptor ud{"Calculus", "MSU", 0.5, 4, 2.0, 2.0, 3, 0.5, 2.0, std::nullopt};
     UnitDescriptor ud1{"Commision", "MEPhI", 0.7, 4, 1.0, 2.0, 3, 0.5, 2.0, 0.0};
-    Matrix<GameCell, FIELD_WEIGHT, FIELD_HEIGHT> field;
+    Grid<GameCell> field{DEFAULT_FIELD_WIDTH, DEFAULT_FIELD_HEIGHT};
     Skill skill_calculus{ud, Factory::create_amoral_unit, "Classes", 0.0, 0.0, 0.0};
     Skill skill_commision{ud1, Factory::create_moral_unit, "Commision", 0.0, 0.0, 0.0};
     std::vector<Skill> v1 = {skill_calculus};
@@ -83,15 +114,15 @@ TEST_CASE("Game") {
         game.remove_dead();
         REQUIRE(game.teammates().size() == 2);
         auto unit = Factory::create_moral_unit(ud1);
-        unit->characteristics().morality = MAX_MORALITY;
+        unit->morality() = MAX_MORALITY;
         REQUIRE(unit->damage_coefficient(st, game.teammates()[1]) > 1.0);
         double HP_before = game.teammates()[1]->current_HP();
         unit->make_damage(game, game.teammates()[1]);
         double HP_after = game.teammates()[1]->current_HP();
         REQUIRE((HP_before - HP_after) - unit->damage() * 1.2 * 2.0 < 0.001);
         unit->take_damage(4.2);
-        REQUIRE(unit->characteristics().amount == 2);
-        REQUIRE(unit->characteristics().morality < MAX_MORALITY);
+        REQUIRE(unit->amount() == 2);
+        REQUIRE(unit->morality() < MAX_MORALITY);
         REQUIRE(game.teammates()[1]->damage_coefficient(st, unit) < 1.0);
     }
     SECTION("Keeping lists sorted") {
@@ -101,10 +132,10 @@ TEST_CASE("Game") {
         auto unit_b = Factory::create_amoral_unit(ud);
         auto unit_c = Factory::create_amoral_unit(ud);
         auto unit_d = Factory::create_amoral_unit(ud);
-        unit_a->characteristics().initiative = 4;
-        unit_b->characteristics().initiative = 3;
-        unit_c->characteristics().initiative = 2;
-        unit_d->characteristics().initiative = 1;
+        unit_a->initiative() = 4;
+        unit_b->initiative() = 3;
+        unit_c->initiative() = 2;
+        unit_d->initiative() = 1;
         game.deploy_unit(0, 0, unit_d, PLAYER);
         game.deploy_unit(1, 1, unit_b, PLAYER);
         game.deploy_unit(2, 2, unit_a, PLAYER);
@@ -115,28 +146,28 @@ TEST_CASE("Game") {
         REQUIRE(game.teammates()[2] == unit_c);
         REQUIRE(game.teammates()[3] == unit_d);
         auto unit_e = Factory::create_amoral_unit(ud);
-        unit_e->characteristics().initiative = 5;
+        unit_e->initiative() = 5;
         game.deploy_unit(4, 4, unit_e, PLAYER);
         REQUIRE(game.teammates()[0] == unit_e);
     }
     SECTION("Morality") {
         auto unit = Factory::create_moral_unit(ud1);
         unit->increase_morality(0.2);
-        REQUIRE(unit->characteristics().morality == 0.2);
+        REQUIRE(unit->morality() == 0.2);
         unit->increase_morality(1.0);
-        REQUIRE(unit->characteristics().morality == MAX_MORALITY);
+        REQUIRE(unit->morality() == MAX_MORALITY);
         unit->decrease_morality(3.0);
-        REQUIRE(unit->characteristics().morality == MIN_MORALITY);
-        unit->characteristics().morality = 0.08;
+        REQUIRE(unit->morality() == MIN_MORALITY);
+        unit->morality() = 0.08;
         unit->balance_morality();
-        REQUIRE(unit->characteristics().morality == 0.03);
+        REQUIRE(unit->morality() == 0.03);
         unit->balance_morality();
-        REQUIRE(unit->characteristics().morality == 0.0);
-        unit->characteristics().morality = -0.08;
+        REQUIRE(unit->morality() == 0.0);
+        unit->morality() = -0.08;
         unit->balance_morality();
-        REQUIRE(unit->characteristics().morality == -0.03);
+        REQUIRE(unit->morality() == -0.03);
        unit->balance_morality();
-        REQUIRE(unit->characteristics().morality == 0.0);
+        REQUIRE(unit->morality() == 0.0);
     }
     SECTION("Summoner") {
         SchoolsTable st{table};
@@ -157,11 +188,11 @@ TEST_CASE("Game") {
         summoner->accumulate_energy();
         REQUIRE(summoner->characteristics().current_energy == energy_before * summoner->characteristics().accumulation_coefficient);
         summoner->characteristics().current_energy = 0.0;
-        game.schools_table().get_skill("MSU", "Classes").required_energy = 1.0;
+        game.edit_schools_table().get_skill("MSU", "Classes").required_energy = 1.0;
         REQUIRE_THROWS(summoner->summon_unit(game, "MSU", "Classes", 2, 2));
         summoner->characteristics().current_energy = 2.0;
         summoner->characteristics().schools_knowledge["MSU"] = 10.0;
-        game.schools_table().get_skill("MSU", "Classes").min_knowledge = 100.0;
+        game.edit_schools_table().get_skill("MSU", "Classes").min_knowledge = 100.0;
         REQUIRE_THROWS(summoner->summon_unit(game, "MSU", "Classes", 2, 2)); 
     }
     SECTION("XP") {
@@ -178,10 +209,10 @@ TEST_CASE("Game") {
     SECTION("Move and cells avialability") {
         SchoolsTable st{table};
         Game game{st, field};
-        game.field().at(0, 0).type() = OBSTACLE;
+        game.edit_field().at(0, 0).type() = OBSTACLE;
         auto summoner = std::make_shared<Summoner>(0, 0, e_sd);
         REQUIRE_THROWS(game.deploy_unit(0, 0, summoner, PLAYER));
-        game.field().at(0, 0).type() = LAND;
+        game.edit_field().at(0, 0).type() = LAND;
         game.deploy_unit(0, 0, summoner, PLAYER);
         REQUIRE_THROWS(game.deploy_unit(0, 0, Factory::create_amoral_unit(ud), PLAYER));
         REQUIRE_THROWS(summoner->move(game, 10, 10));
@@ -194,18 +225,154 @@ TEST_CASE("Game") {
         REQUIRE_THROWS(summoner->move(game, 2, 2));
         REQUIRE_THROWS(other_unit->move(game, 50, 50));
     }
+    SECTION("Occupancy") {
+        SchoolsTable st{table};
+        Game game{st, field};
+        auto unit = Factory::create_amoral_unit(ud);
+        auto enemy = Factory::create_ressurection_unit(ud);
+        game.deploy_unit(1, 1, unit, PLAYER);
+        game.deploy_unit(5, 5, enemy, ENEMY);
+        REQUIRE(game.unit_at(1, 1) == unit.get());
+        REQUIRE(game.find_enemy(5, 5, PLAYER) == enemy);
+        REQUIRE_THROWS(game.find_enemy(1, 1, PLAYER));
+        unit->move(game, 2, 3);
+        REQUIRE(game.unit_at(1, 1) == nullptr);
+        REQUIRE(game.unit_at(2, 3) == unit.get());
+        enemy->move(game, 4, 4);
+        REQUIRE(game.unit_at(4, 4) == enemy.get());
+        REQUIRE(game.is_avialable(5, 5));
+        enemy->take_damage(1000);
+        game.remove_dead();
+        REQUIRE(game.is_avialable(4, 4));
+        game.remove_unit(unit);
+        REQUIRE(game.is_avialable(2, 3));
+    }
+    SECTION("Unit store") {
+        SchoolsTable st{table};
+        Game game{st, field};
+        auto unit = Factory::create_ressurection_unit(ud);
+        unit->take_damage(ud.entity_HP);
+        game.deploy_unit(3, 3, unit, PLAYER);
+        game.deploy_unit(4, 4, Factory::create_moral_unit(ud1), ENEMY);
+        REQUIRE(game.store().live() == 2);
+        uint32_t slot = unit->slot();
+        REQUIRE(game.store().owner[slot] == unit.get());
+        REQUIRE(game.store().amount[slot] == ud.max_amount - 1);
+        REQUIRE(game.store().school_name(game.store().school[slot]) == "MSU");
+        unit->take_damage(1.0);
+        REQUIRE(game.store().hp[slot] == unit->current_HP());
+        unit->move(game, 5, 5);
+        REQUIRE((game.store().x[slot] == 5 && game.store().y[slot] == 5));
+        game.remove_unit(unit);
+        REQUIRE(game.store().live() == 1);
+        REQUIRE(unit->store() == nullptr);
+        REQUIRE(unit->current_HP() == ud.current_HP - ud.entity_HP - 1.0);
+        REQUIRE(unit->x() == 5);
+        game.deploy_unit(6, 6, Factory::create_amoral_unit(ud), PLAYER);
+        REQUIRE(game.store().slots() == 2);
+    }
+    SECTION("Unit pool") {
+        SchoolsTable st{table};
+        Game game{st, field};
+        auto summoner = std::make_shared<Summoner>(0, 0, e_sd);
+        game.deploy_unit(0, 0, summoner, ENEMY);
+        summoner->summon_unit(game, "MSU", "Classes", 2, 2);
+        REQUIRE(game.unit_pool()->in_use() == 1);
+        size_t heap_allocations = game.unit_pool()->heap_allocations();
+        for (int i = 0; i < 1000; ++i) {
+            game.enemies()[1]->take_damage(1000000);
+            game.remove_dead();
+            summoner->summon_unit(game, "MSU", "Classes", 2, 2);
+        }
+        REQUIRE(game.unit_pool()->allocations() == 1001);
+        REQUIRE(game.unit_pool()->in_use() == 1);
+        REQUIRE(game.unit_pool()->heap_allocations() == heap_allocations);
+        auto pool = std::make_shared<UnitPool>();
+        auto unit = Factory::create_ressurection_unit(ud, pool);
+        REQUIRE(pool->in_use() == 2);
+        unit.reset();
+        REQUIRE(pool->in_use() == 0);
+    }
+    SECTION("Unit dispatch") {
+        SchoolsTable st{table};
+        Game game{st, field};
+        auto summoner = std::make_shared<Summoner>(0, 0, p_sd);
+        auto moral = Factory::create_moral_unit(ud1);
+        auto ressurection = Factory::create_ressurection_unit(ud);
+        game.deploy_unit(0, 0, summoner, PLAYER);
+        game.deploy_unit(1, 1, moral, ENEMY);
+        game.deploy_unit(2, 2, ressurection, ENEMY);
+        REQUIRE(summoner->kind() == SUMMONER);
+        REQUIRE(game.store().kind[moral->slot()] == MORAL);
+        REQUIRE(ressurection->kind() == RESSURECTION);
+        REQUIRE(ressurection->unit()->kind() == AMORAL);
+        REQUIRE(Factory::create_kamikaze(ud)->kind() == KAMIKAZE);
+        REQUIRE(std::string(UnitDispatch::kind_name(RESSURECTION)) == "Ressurection");
+        UnitDispatch::take_damage(*moral, 2.0);
+        REQUIRE(moral->current_HP() == ud1.current_HP - 2.0);
+        REQUIRE(moral->morality() == -0.01);
+        UnitDispatch::take_damage(*ressurection, 1.0);
+        REQUIRE(ressurection->current_HP() == ud.current_HP - 1.0);
+        UnitDispatch::make_damage(*summoner, game, moral);
+        REQUIRE(moral->current_HP() == ud1.current_HP - 2.0 - p_sd.damage);
+    }
+    SECTION("Spatial index") {
+        SchoolsTable st{table};
+        Game game{st, field};
+        game.deploy_unit(10, 10, Factory::create_amoral_unit(ud), ENEMY);
+        game.deploy_unit(20, 20, Factory::create_amoral_unit(ud), ENEMY);
+        game.deploy_unit(3, 4, Factory::create_amoral_unit(ud), ENEMY);
+        game.deploy_unit(0, 0, Factory::create_amoral_unit(ud), PLAYER);
+        REQUIRE(game.find_closest_enemy(0, 0, PLAYER) == game.find_enemy(3, 4, PLAYER));
+        REQUIRE(game.find_closest_enemy(18, 18, PLAYER) == game.find_enemy(20, 20, PLAYER));
+        REQUIRE(game.find_closest_enemy(5, 5, ENEMY) == game.teammates()[0]);
+        auto closest = game.find_closest_enemies(0, 0, PLAYER, 2);
+        REQUIRE(closest.size() == 2);
+        REQUIRE(closest[0] == game.find_enemy(3, 4, PLAYER));
+        REQUIRE(closest[1] == game.find_enemy(10, 10, PLAYER));
+        REQUIRE(game.find_enemies_within(0, 0, PLAYER, 5).size() == 1);
+        REQUIRE(game.find_enemies_within(0, 0, PLAYER, 15).size() == 2);
+        game.find_enemy(3, 4, PLAYER)->move(game, 5, 5);
+        REQUIRE(game.find_enemies_within(0, 0, PLAYER, 5).size() == 0);
+        REQUIRE(game.find_closest_enemy(0, 0, PLAYER) == game.find_enemy(5, 5, PLAYER));
+        game.find_enemy(5, 5, PLAYER)->take_damage(1000);
+        game.remove_dead();
+        REQUIRE(game.find_closest_enemy(0, 0, PLAYER) == game.find_enemy(10, 10, PLAYER));
+    }
     SECTION("Ressurection") {
-        std::mt19937 gen{123456};
+        RandomStream gen{123456};
         auto ru = Factory::create_ressurection_unit(ud);
-        ru->characteristics().amount = ud.max_amount - 3;
+        ru->amount() = ud.max_amount - 3;
         ru->try_to_ressurect(gen);
-        REQUIRE(ru->characteristics().amount > ud.max_amount - 3);
+        REQUIRE(ru->amount() > ud.max_amount - 3);
+        REQUIRE(ru->amount() <= ud.max_amount);
+    }
+    SECTION("Random streams") {
+        RandomStream stream{7};
+        RandomStream same{7};
+        REQUIRE(stream() == same());
+        REQUIRE(stream.counter() == 1);
+        REQUIRE(stream.substream(3)() == same.substream(3)());
+        REQUIRE(stream.substream(3)() != stream.substream(4)());
+        SchoolsTable st;
+        Game game{st, field};
+        Game other{st, field};
+        game.seed(11);
+        other.seed(11);
+        REQUIRE(game.stream(5)() == other.stream(5)());
+        REQUIRE(game.stream(5)() != game.stream(6)());
+        double sum = 0;
+        for (int i = 0; i < 1000; ++i) {
+            sum += stream.uniform();
+        }
+        REQUIRE((sum > 450 && sum < 550));
     }
     SECTION("Death") {
         SchoolsTable st;
         Game game{st, field};
-        auto unit = Factory::create_moral_unit(ud1);
-        unit->characteristics().damage = 1000;
+        UnitDescriptor deadly = ud1;
+        deadly.damage = 1000;
+        auto unit = Factory::create_moral_unit(deadly);
         game.deploy_unit(1, 1, Factory::create_amoral_unit(ud), ENEMY);
         unit->make_damage(game, game.enemies()[0]);
         REQUIRE(game.enemies()[0]->current_HP() == 0);
@@ -215,8 +382,9 @@ TEST_CASE("Game") {
         game.remove_unit(game.enemies()[0]);
         game.deploy_unit(0, 0, std::make_shared<Summoner>(0, 0, p_sd), PLAYER);
         REQUIRE_THROWS(unit->make_damage(game, game.teammates()[0]));
-        auto killer = Factory::create_amoral_unit(ud);
-        killer->characteristics().damage = 1000;
+        UnitDescriptor deadly_amoral = ud;
+        deadly_amoral.damage = 1000;
+        auto killer = Factory::create_amoral_unit(deadly_amoral);
         auto victim = Factory::create_moral_unit(ud1);
         REQUIRE_NOTHROW(killer->make_damage(game, victim));
         REQUIRE(victim->current_HP() == 0);
@@ -248,6 +416,449 @@ TEST_CASE("Game") {
         REQUIRE(game.enemies()[0]->current_HP() == 20);
         REQUIRE(game.teammates()[0]->current_HP() == 30);
     }
+    SECTION("Large field") {
+        Game loaded{"../../data/Units/", "../../data/Skills/", "../../data/Schools/", "../../data/Summoners/Student.json", "../../data/Summoners/D.S.Telyakovskii.json", "../../data/Field/StressField.json"};
+        REQUIRE((loaded.field_width() == 4096 && loaded.field_height() == 4096));
+        REQUIRE(loaded.enemies()[0]->x() == 4086);
+        SchoolsTable st{table};
+        Game game{st, Grid<GameCell>(4096, 4096)};
+        game.deploy_unit(4000, 4000, std::make_shared<Summoner>(0, 0, e_sd), ENEMY);
+        auto unit = Factory::create_amoral_unit(ud);
+        game.deploy_unit(5, 5, unit, PLAYER);
+        game.do_tick();
+        REQUIRE(game.enemies().size() == 2);
+        REQUIRE(unit->x() == 5 + ud.speed);
+    }
+    SECTION("Pathfinding") {
+        Grid<GameCell> walled{field};
+        for (int y = 0; y < 30; ++y) {
+            walled.at(10, y) = OBSTACLE;
+        }
+        FlowField paths;
+        paths.build(walled, {{20, 5}}, {});
+        REQUIRE(paths.distance(10, 5) == FlowField::unreachable);
+        REQUIRE(paths.distance(10, 30) == 25);
+        REQUIRE(paths.distance(5, 5) == 50);
+        auto [x, y] = paths.step(5, 5, 3, [](int, int){ return true; });
+        REQUIRE(paths.distance(x, y) == 47);
+        REQUIRE(paths.step(5, 5, 3, [](int, int){ return false; }) == FlowField::point_t{5, 5});
+        SchoolsTable st{table};
+        Game game{st, walled};
+        auto unit = Factory::create_amoral_unit(ud);
+        UnitDescriptor rooted = ud;
+        rooted.speed = 0;
+        auto enemy = Factory::create_amoral_unit(rooted);
+        game.deploy_unit(9, 5, unit, PLAYER);
+        game.deploy_unit(20, 5, enemy, ENEMY);
+        for (int tick = 0; tick < 30 && enemy->current_HP() == ud.current_HP; ++tick) {
+            game.do_tick();
+        }
+        REQUIRE(unit->x() > 10);
+        REQUIRE(enemy->current_HP() < ud.current_HP);
+    }
+    SECTION("Hierarchical pathfinding") {
+        Grid<GameCell> walled{200, 200, LAND};
+        for (int y = 0; y < 180; ++y) {
+            walled.at(100, y) = OBSTACLE;
+        }
+        PathHierarchy hierarchy{16};
+        hierarchy.refresh(walled);
+        REQUIRE(hierarchy.clusters() == 13 * 13);
+        FlowField reference;
+        reference.build(walled, {{110, 10}}, {});
+        int x = 90, y = 10;
+        uint32_t steps = 0;
+        while ((x != 110 || y != 10) && steps < 1000) {
+            std::tie(x, y) = hierarchy.step(x, y, 110, 10, 1, [](int, int){ return true; });
+            ++steps;
+        }
+        REQUIRE((x == 110 && y == 10));
+        REQUIRE(steps <= reference.distance(90, 10) + reference.distance(90, 10) / 10);
+        REQUIRE(hierarchy.step(90, 10, 110, 10, 5, [](int, int){ return false; }) == PathHierarchy::point_t{90, 10});
+        size_t built = hierarchy.built_clusters();
+        REQUIRE(hierarchy.route(90, 10, 110, 10).back() == PathHierarchy::point_t{110, 10});
+        REQUIRE(hierarchy.built_clusters() == built);
+        REQUIRE(hierarchy.route(20, 150, 110, 10).back() == PathHierarchy::point_t{110, 10});
+        REQUIRE(hierarchy.cached_goals() == 1);
+        walled.at(150, 150) = OBSTACLE;
+        hierarchy.invalidate(150, 150);
+        hierarchy.refresh(walled);
+        REQUIRE(hierarchy.cached_goals() == 0);
+        hierarchy.route(90, 10, 110, 10);
+        REQUIRE(hierarchy.built_clusters() - built <= 9);
+        for (int y = 180; y < 200; ++y) {
+            walled.at(100, y) = OBSTACLE;
+            hierarchy.invalidate(100, y);
+        }
+        hierarchy.refresh(walled);
+        REQUIRE(hierarchy.route(90, 10, 110, 10).empty());
+    }
+    SECTION("Field components") {
+        Grid<GameCell> open{20, 20, LAND};
+        FieldComponents components;
+        components.build(open);
+        REQUIRE(components.count() == 1);
+        for (int y = 0; y < 20; ++y) {
+            open.at(10, y) = OBSTACLE;
+            components.update(open, 10, y);
+        }
+        REQUIRE(components.count() == 2);
+        REQUIRE_FALSE(components.connected(0, 0, 19, 19));
+        REQUIRE(components.connected(0, 0, 9, 19));
+        REQUIRE(components.component(10, 5) == FieldComponents::none);
+        open.at(10, 7) = LAND;
+        components.update(open, 10, 7);
+        REQUIRE(components.count() == 1);
+        REQUIRE(components.connected(0, 0, 19, 19));
+        open.at(15, 15) = OBSTACLE;
+        components.update(open, 15, 15);
+        REQUIRE(components.count() == 1);
+        for (auto [x, y] : std::vector<std::pair<int, int>>{{2, 2}, {2, 3}, {2, 4}, {3, 4}, {4, 4}, {4, 3}, {4, 2}, {3, 2}}) {
+            open.at(x, y) = OBSTACLE;
+            components.update(open, x, y);
+        }
+        REQUIRE(components.count() == 2);
+        REQUIRE_FALSE(components.connected(3, 3, 0, 0));
+        FieldComponents fresh;
+        fresh.build(open);
+        REQUIRE(fresh.count() == components.count());
+        SchoolsTable st{table};
+        Game game{st, field};
+        auto unit = Factory::create_amoral_unit(ud);
+        UnitDescriptor rooted = ud;
+        rooted.speed = 0;
+        auto enemy = Factory::create_amoral_unit(rooted);
+        game.deploy_unit(5, 5, unit, PLAYER);
+        game.deploy_unit(30, 5, enemy, ENEMY);
+        for (int y = 0; y < DEFAULT_FIELD_HEIGHT; ++y) {
+            game.set_cell(20, y, OBSTACLE);
+        }
+        REQUIRE_FALSE(game.reachable(5, 5, 30, 5));
+        REQUIRE(game.find_closest_enemy(5, 5, PLAYER) == nullptr);
+        game.do_tick();
+        REQUIRE((unit->x() == 5 && unit->y() == 5));
+        auto summoned = Factory::create_amoral_unit(rooted);
+        game.deploy_unit(5, 30, summoned, ENEMY);
+        REQUIRE(game.find_closest_enemy(5, 5, PLAYER) == summoned);
+        game.remove_unit(summoned);
+        REQUIRE(game.find_closest_enemy(5, 5, PLAYER) == nullptr);
+        game.set_cell(20, DEFAULT_FIELD_HEIGHT - 1, LAND);
+        REQUIRE(game.reachable(5, 5, 30, 5));
+        REQUIRE(game.find_closest_enemy(5, 5, PLAYER) == enemy);
+    }
+    SECTION("Non-throwing actions") {
+        SchoolsTable st{table};
+        Game game{st, field};
+        auto unit = Factory::create_amoral_unit(ud);
+        auto other = Factory::create_amoral_unit(ud);
+        REQUIRE(game.try_deploy(5, 5, unit, PLAYER));
+        REQUIRE(game.try_deploy(5, 5, other, PLAYER).error() == CELL_UNAVIALABLE);
+        REQUIRE(game.try_deploy(-1, 5, other, PLAYER).error() == CELL_UNAVIALABLE);
+        REQUIRE(game.try_deploy(6, 5, other, ENEMY));
+        REQUIRE(unit->try_move(game, 5 + ud.speed + 1, 5).error() == TOO_FAR);
+        REQUIRE(unit->try_move(game, 6, 5).error() == CELL_UNAVIALABLE);
+        REQUIRE(unit->try_move(game, 4, 4));
+        REQUIRE((unit->x() == 4 && unit->y() == 4));
+        REQUIRE_THROWS_AS(unit->move(game, 6, 5), std::invalid_argument);
+        REQUIRE(game.schools_table().find_skill("MSU", "Classes").value()->name == "Classes");
+        REQUIRE(game.schools_table().find_skill("MSU", "Lectures").error() == NO_SUCH_SKILL);
+        REQUIRE(game.schools_table().find_skill("HSE", "Classes").error() == NO_SUCH_SKILL);
+        REQUIRE(game.schools_table().schools_amount() == 2);
+        auto summoner = std::make_shared<Summoner>(0, 0, e_sd);
+        game.deploy_unit(0, 0, summoner, ENEMY);
+        summoner->characteristics().current_energy = 0.0;
+        game.edit_schools_table().get_skill("MSU", "Classes").required_energy = 5.0;
+        REQUIRE(summoner->try_summon_unit(game, "MSU", "Classes", 1, 1).error() == NOT_ENOUGH_ENERGY);
+        REQUIRE_THROWS_AS(summoner->summon_unit(game, "MSU", "Classes", 1, 1), std::runtime_error);
+        summoner->characteristics().current_energy = 10.0;
+        REQUIRE(summoner->try_summon_unit(game, "MSU", "Classes", 0, 0).error() == CELL_UNAVIALABLE);
+        REQUIRE(summoner->try_summon_unit(game, "MSU", "Classes", 1, 1));
+        REQUIRE(summoner->characteristics().current_energy == 5.0);
+        REQUIRE(summoner->try_move(game, 3, 3).error() == TOO_FAR);
+    }
+    SECTION("Symbols") {
+        Symbol msu{"MSU"};
+        REQUIRE(msu == Symbol(std::string("MSU")));
+        REQUIRE(msu.name() == "MSU");
+        REQUIRE(Symbol().empty());
+        REQUIRE(Symbol().name().empty());
+        size_t count = Symbol::count();
+        Symbol fresh{"A school nobody has heard of"};
+        REQUIRE(Symbol::count() == count + 1);
+        REQUIRE(fresh.id() == count);
+        REQUIRE(fresh != msu);
+        REQUIRE(ud.school == msu);
+        REQUIRE(e_sd.schools_knowledge.at(msu) == 100.0);
+        SchoolsTable st{table};
+        REQUIRE(st.table().count(msu) == 1);
+        REQUIRE(st.get_school(mephi.name).dominant_for.front() == msu);
+        std::ostringstream out;
+        out << msu;
+        REQUIRE(out.str() == "MSU");
+    }
+    SECTION("Dominance matrix") {
+        REQUIRE(msu < mephi);
+        REQUIRE(mephi > msu);
+        SchoolsTable st{table};
+        REQUIRE(st.coefficient("MEPhI", "MSU") == DOMINANT_COEFFICIENT);
+        REQUIRE(st.coefficient("MSU", "MEPhI") == SUBMISSIVE_COEFFICIENT);
+        REQUIRE(st.coefficient("MSU", "MSU") == 1.0);
+        REQUIRE(st.coefficient("MSU", Symbol()) == 1.0);
+        REQUIRE(st.coefficient("Unknown school", "MSU") == 1.0);
+        st.get_school("MSU").dominant_for.push_back("Newcomers");
+        REQUIRE(st.coefficient("MSU", "Newcomers") == 1.0);
+        st.get_school("Newcomers");
+        REQUIRE(st.coefficient("MSU", "Newcomers") == DOMINANT_COEFFICIENT);
+        Game game{st, field};
+        auto attacker = Factory::create_amoral_unit(ud1);
+        auto defender = Factory::create_amoral_unit(ud);
+        game.deploy_unit(0, 0, attacker, PLAYER);
+        game.deploy_unit(1, 1, defender, ENEMY);
+        double damage = attacker->damage();
+        UnitDispatch::make_damage(*attacker, game, defender);
+        REQUIRE(defender->current_HP() == ud.current_HP - DOMINANT_COEFFICIENT * damage);
+    }
+    SECTION("Skill ranking") {
+        SchoolsTable st{table};
+        UnitDescriptor strong{"Exam", "MSU", 0.5, 4, 5.0, 2.0, 3, 0.5, 2.0, std::nullopt};
+        UnitDescriptor elite{"Defence", "MSU", 0.5, 4, 9.0, 2.0, 3, 0.5, 2.0, std::nullopt};
+        st.add_skill({strong, Factory::create_amoral_unit, "Exams", 0.0, 50.0, 0.0});
+        st.add_skill({elite, Factory::create_amoral_unit, "Defences", 90.0, 20.0, 0.0});
+        REQUIRE(st.find_skill("MSU", "Exams").value()->characteristics.damage == 5.0);
+        REQUIRE(st.catalog_stale());
+        auto exams = st.find_skill("MSU", "Exams").value()->unit;
+        REQUIRE(st.find_skill("MSU", "Exams").value()->unit.get() == exams.get());
+        st.refresh_catalog();
+        REQUIRE(st.best_skill("MSU", 10.0, 100.0)->name == "Classes");
+        REQUIRE(st.best_skill("MSU", 30.0, 100.0)->name == "Defences");
+        REQUIRE(st.best_skill("MSU", 30.0, 50.0)->name == "Classes");
+        REQUIRE(st.best_skill("MSU", 60.0, 50.0)->name == "Exams");
+        REQUIRE(st.best_skill("MSU", 60.0, 100.0)->name == "Defences");
+        REQUIRE(st.best_skill("HSE", 60.0, 100.0) == nullptr);
+        REQUIRE(st.best_skill("MSU", -1.0, 100.0) == nullptr);
+        Game game{st, field};
+        auto summoner = std::make_shared<Summoner>(10, 10, e_sd);
+        game.deploy_unit(10, 10, summoner, ENEMY);
+        game.deploy_unit(20, 20, Factory::create_amoral_unit(ud1), PLAYER);
+        summoner->characteristics().current_energy = 30.0;
+        summoner->make_turn(game, ENEMY);
+        REQUIRE(summoner->characteristics().current_energy == 10.0);
+        REQUIRE(game.enemies().size() == 2);
+    }
+    SECTION("Unit templates") {
+        SchoolsTable st{table};
+        Game game{st, field};
+        auto summoner = std::make_shared<Summoner>(10, 10, e_sd);
+        game.deploy_unit(10, 10, summoner, ENEMY);
+        summoner->summon_unit(game, "MSU", "Classes", 11, 11);
+        summoner->summon_unit(game, "MSU", "Classes", 9, 9);
+        auto first = std::static_pointer_cast<RealUnit>(game.find_enemy(11, 11, PLAYER));
+        auto second = std::static_pointer_cast<RealUnit>(game.find_enemy(9, 9, PLAYER));
+        REQUIRE(first->unit_template().get() == second->unit_template().get());
+        REQUIRE(first->unit_template().get() == game.schools_table().get_skill("MSU", "Classes").unit.get());
+        first->take_damage(1.0);
+        REQUIRE(second->current_HP() == ud.current_HP);
+        REQUIRE(first->characteristics().current_HP == ud.current_HP);
+        REQUIRE(sizeof(AmoralUnit) <= 11 * sizeof(void*));
+        REQUIRE(sizeof(MoralUnit) <= 12 * sizeof(void*));
+        auto ressurection = Factory::create_ressurection_unit(ud);
+        REQUIRE(ressurection->unit_template().get() == ressurection->unit()->unit_template().get());
+    }
+    SECTION("Shared catalog") {
+        auto catalog = Game::read_schools_table("../../data/Units/", "../../data/Skills/", "../../data/Schools/");
+        REQUIRE_FALSE(catalog->catalog_stale());
+        REQUIRE(catalog->schools_amount() == 2);
+        Game one{catalog, field};
+        Game two{catalog, field};
+        REQUIRE(&one.schools_table() == catalog.get());
+        REQUIRE(&two.schools_table() == catalog.get());
+        REQUIRE(one.catalog() == catalog);
+        REQUIRE_THROWS_AS(catalog->get_school("HSE"), std::invalid_argument);
+        REQUIRE(catalog->find_school("HSE") == nullptr);
+        REQUIRE(catalog->schools_amount() == 2);
+        Symbol school = catalog->begin()->first;
+        const Skill& skill = catalog->begin()->second.skills.front();
+        one.edit_schools_table().get_skill(school, skill.name).required_energy = skill.required_energy + 1.0;
+        REQUIRE(&one.schools_table() != catalog.get());
+        REQUIRE(one.schools_table().get_skill(school, skill.name).required_energy == skill.required_energy + 1.0);
+        REQUIRE(two.schools_table().get_skill(school, skill.name).required_energy == skill.required_energy);
+        auto edited = one.catalog();
+        REQUIRE_FALSE(edited->catalog_stale());
+        one.edit_schools_table();
+        REQUIRE(one.catalog() != edited);
+    }
+    SECTION("Catalog file") {
+        std::string path = (std::filesystem::temp_directory_path() / "summoners_test_catalog.bin").string();
+        CatalogFile::compile("../../data/Units/", "../../data/Skills/", "../../data/Schools/", path);
+        REQUIRE_FALSE(CatalogFile::stale(path, "../../data/Units/", "../../data/Skills/", "../../data/Schools/"));
+        {
+            CatalogFile catalog{path};
+            REQUIRE(catalog.units().size() == 6);
+            REQUIRE(catalog.skills().size() == 6);
+            REQUIRE(catalog.schools().size() == 2);
+            auto loaded = catalog.schools_table();
+            REQUIRE_FALSE(loaded->catalog_stale());
+            REQUIRE(loaded->units_amount() == 6);
+            REQUIRE(loaded->find_unit("Calculus")->damage == 1.2);
+            REQUIRE(loaded->find_unit("Calculus")->morality == std::nullopt);
+            REQUIRE(loaded->get_skill("MSU", "TFKP").required_energy == 30.0);
+            REQUIRE(loaded->get_skill("MSU", "TFKP").characteristics.name == "Imaginary Unit");
+            REQUIRE(loaded->get_skill("MSU", "TFKP").unit.get() == loaded->find_unit("Imaginary Unit").get());
+            REQUIRE(loaded->get_school("MSU").skills.size() == 2);
+        }
+        auto damage = [&](size_t offset, uint32_t value) {
+            std::fstream file(path, std::ios::binary | std::ios::in | std::ios::out);
+            file.seekp(offset);
+            file.write(reinterpret_cast<const char*>(&value), sizeof(value));
+        };
+        size_t skills_offset = BinaryWriter::aligned(sizeof(CatalogHeader)) + BinaryWriter::aligned(sizeof(CatalogUnit) * 6);
+        damage(skills_offset + offsetof(CatalogSkill, kind), SUMMONER);
+        REQUIRE_THROWS_AS(CatalogFile{path}, std::runtime_error);
+        CatalogFile::compile("../../data/Units/", "../../data/Skills/", "../../data/Schools/", path);
+        damage(skills_offset + BinaryWriter::aligned(sizeof(CatalogSkill) * 6) + offsetof(CatalogSchool, first_skill), 1000000);
+        REQUIRE_THROWS_AS(CatalogFile{path}, std::runtime_error);
+        REQUIRE(strings_valid(std::vector<uint32_t>{0, 3, 3, 6}, 6));
+        REQUIRE_FALSE(strings_valid(std::vector<uint32_t>{0, 5, 3, 6}, 6));
+        CatalogFile::compile("../../data/Units/", "../../data/Skills/", "../../data/Schools/", path);
+        std::filesystem::last_write_time(path, std::filesystem::last_write_time("../../data/Units/") - std::chrono::hours(1));
+        REQUIRE(CatalogFile::stale(path, "../../data/Units/", "../../data/Skills/", "../../data/Schools/"));
+        std::filesystem::resize_file(path, std::filesystem::file_size(path) - 8);
+        REQUIRE_THROWS_AS(CatalogFile{path}, std::runtime_error);
+        std::filesystem::remove(path);
+        REQUIRE(CatalogFile::stale(path, "../../data/Units/", "../../data/Skills/", "../../data/Schools/"));
+        REQUIRE(CatalogFile::default_path("../../data/Units/") == "../../data/Catalog.bin");
+    }
+#ifdef SUMMONERS_BUILTIN_CATALOG
+    SECTION("Built-in catalog") {
+        auto builtin = BuiltinCatalog::schools_table();
+        REQUIRE(Game::read_schools_table("", "", "") == builtin);
+        std::string path = (std::filesystem::temp_directory_path() / "summoners_test_builtin.bin").string();
+        CatalogFile::compile("../../data/Units/", "../../data/Skills/", "../../data/Schools/", path);
+        auto loaded = CatalogFile(path).schools_table();
+        std::filesystem::remove(path);
+        REQUIRE(builtin->units_amount() == loaded->units_amount());
+        REQUIRE(builtin->skills_amount() == loaded->skills_amount());
+        REQUIRE(builtin->schools_amount() == loaded->schools_amount());
+        REQUIRE(*builtin->find_unit("Calculus") == *loaded->find_unit("Calculus"));
+        REQUIRE(builtin->get_skill("MSU", "TFKP").unit.get() == builtin->find_unit("Imaginary Unit").get());
+        for (const auto& [attacker, one] : *loaded) {
+            for (const auto& [defender, two] : *loaded) {
+                REQUIRE(builtin->coefficient(attacker, defender) == loaded->coefficient(attacker, defender));
+            }
+        }
+        auto student = BuiltinCatalog::summoner("Student.json", ENEMY);
+        REQUIRE(student.has_value());
+        REQUIRE(student->name == "MEPhI student");
+        REQUIRE(student->team == ENEMY);
+        REQUIRE(student->schools_knowledge.at("MEPhI") == 25.0);
+        REQUIRE_FALSE(BuiltinCatalog::summoner("Missing.json", PLAYER).has_value());
+    }
+#endif
+    SECTION("Parallel catalog loading") {
+        auto root = std::filesystem::temp_directory_path() / "summoners_test_mod";
+        std::filesystem::remove_all(root);
+        for (const char* dir : {"Units", "Skills", "Schools"}) {
+            std::filesystem::create_directories(root / dir);
+            std::filesystem::copy(std::filesystem::path("../../data") / dir, root / dir);
+        }
+        std::ofstream(root / "Units" / "Broken.json") << "{\"name\": ";
+        std::ofstream(root / "Skills" / "Orphan.json") << R"({"entity":"Nobody","knowledge_coefficient":1.0,"min_knowledge":1.0,"name":"Orphan","required_energy":1.0,"type":"Moral"})";
+        std::ofstream(root / "Schools" / "Untyped.json") << R"({"name":"Untyped","skills":"TFKP","dominant_for":[]})";
+        std::string units = (root / "Units").string(), skills = (root / "Skills").string(), schools = (root / "Schools").string();
+        TaskScheduler scheduler{3, 1};
+        TaskScheduler serial{0};
+        CatalogReport report = CatalogFile::compile(units, skills, schools, (root / "parallel.bin").string(), &scheduler);
+        CatalogReport serial_report = CatalogFile::compile(units, skills, schools, (root / "serial.bin").string(), &serial);
+        REQUIRE(report.files == 17);
+        REQUIRE(report.threads == 4);
+        REQUIRE(serial_report.threads == 1);
+        REQUIRE(report.errors.size() == 3);
+        REQUIRE(report.errors[0].file == (root / "Units" / "Broken.json").string());
+        REQUIRE(report.errors[1].message == "Unknown unit Nobody");
+        REQUIRE(report.errors[2].file == (root / "Schools" / "Untyped.json").string());
+        std::ifstream parallel_file(root / "parallel.bin", std::ios::binary), serial_file(root / "serial.bin", std::ios::binary);
+        REQUIRE(std::string(std::istreambuf_iterator<char>(parallel_file), {}) == std::string(std::istreambuf_iterator<char>(serial_file), {}));
+        auto loaded = CatalogFile((root / "parallel.bin").string()).schools_table();
+        REQUIRE(loaded->units_amount() == 6);
+        REQUIRE(loaded->skills_amount() == 6);
+        REQUIRE(loaded->find_school("Untyped") == nullptr);
+        REQUIRE(CatalogFile::stale((root / "parallel.bin").string(), units, skills, schools));
+        REQUIRE_THROWS_AS(CatalogFile::read_units(units), std::runtime_error);
+        std::filesystem::create_directory(root / CATALOG_FILE_NAME);
+        CatalogReport unwritable;
+        REQUIRE(CatalogFile::load(units, skills, schools, &unwritable)->units_amount() == 6);
+        REQUIRE(unwritable.errors.size() == 4);
+        REQUIRE(unwritable.errors.back().file == (root / CATALOG_FILE_NAME).string());
+        REQUIRE(std::distance(std::filesystem::directory_iterator(root), std::filesystem::directory_iterator()) == 6);
+        std::filesystem::remove_all(root);
+    }
+    SECTION("Task scheduler") {
+        TaskScheduler scheduler{3, 8};
+        std::vector<int> visits(1000, 0);
+        scheduler.parallel_for(0, visits.size(), 16, [&](size_t first, size_t last){
+            for (size_t i = first; i < last; ++i) {
+                ++visits[i];
+            }
+        });
+        REQUIRE(std::all_of(visits.begin(), visits.end(), [](int visit){ return visit == 1; }));
+        std::thread::id caller = std::this_thread::get_id();
+        bool serial = true;
+        scheduler.parallel_for(0, 8, 1, [&](size_t, size_t){ serial = serial && std::this_thread::get_id() == caller; });
+        REQUIRE(serial);
+        REQUIRE_THROWS(scheduler.parallel_for(0, 100, 1, [](size_t first, size_t){ if (first == 42) { throw std::runtime_error("Chunk failed"); } }));
+        SchoolsTable st;
+        Game game{st, field};
+        game.set_scheduler(std::make_shared<TaskScheduler>(3, 16));
+        for (int i = 0; i < 300; ++i) {
+            game.deploy_unit(i % DEFAULT_FIELD_WIDTH, i / DEFAULT_FIELD_WIDTH, Factory::create_moral_unit(ud1), ENEMY);
+        }
+        auto kamikaze = Factory::create_kamikaze(ud);
+        game.deploy_unit(39, 39, kamikaze, PLAYER);
+        kamikaze->damage_all_enemies(game, PLAYER);
+        REQUIRE(std::all_of(game.enemies().begin(), game.enemies().end(), [&](auto& enemy){ return enemy->current_HP() == ud1.current_HP - ud.damage; }));
+        REQUIRE(std::all_of(game.enemies().begin(), game.enemies().end(), [&](auto& enemy){ return enemy->amount() == ud1.max_amount - 1; }));
+    }
+    SECTION("Two-phase tick") {
+        SchoolsTable st{table};
+        auto play = [&](std::shared_ptr<TaskScheduler> scheduler, TickMode mode) {
+            auto game = std::make_unique<Game>(st, field);
+            game->seed(5);
+            game->tick_mode() = mode;
+            game->set_scheduler(scheduler);
+            for (int i = 0; i < 40; ++i) {
+                game->deploy_unit(i % 8, i / 8, i % 2 == 0 ? std::static_pointer_cast<BaseUnit>(Factory::create_moral_unit(ud1)) : Factory::create_ressurection_unit(ud), PLAYER);
+                game->deploy_unit(39 - i % 8, 39 - i / 8, Factory::create_amoral_unit(ud), ENEMY);
+            }
+            for (int tick = 0; tick < 12; ++tick) {
+                game->do_tick();
+            }
+            return game;
+        };
+        auto serial = play(std::make_shared<TaskScheduler>(0), TWO_PHASE);
+        auto parallel = play(std::make_shared<TaskScheduler>(3, 1), TWO_PHASE);
+        auto sequential = play(std::make_shared<TaskScheduler>(0), SEQUENTIAL);
+        REQUIRE(serial->store().hp == parallel->store().hp);
+        REQUIRE(serial->store().x == parallel->store().x);
+        REQUIRE(serial->store().y == parallel->store().y);
+        REQUIRE(serial->teammates().size() == parallel->teammates().size());
+        REQUIRE(serial->enemies().size() < 40);
+        REQUIRE(sequential->enemies().size() < 40);
+    }
+    SECTION("Batch runner") {
+        BatchRunner runner{{"../../data/Units/", "../../data/Skills/", "../../data/Schools/", "../../data/Summoners/Student.json", "../../data/Summoners/D.S.Telyakovskii.json", "../../data/Field/GameField.json"}, 2};
+        BatchReport report = runner.run(8, 1, 500);
+        REQUIRE(report.matches.size() == 8);
+        REQUIRE(report.matches[3].seed == 4);
+        REQUIRE(report.wins(PLAYER) + report.wins(ENEMY) + report.draws() == 8);
+        REQUIRE(report.total_ticks() > 0);
+        MatchResult again = runner.run_match(3, 4, 500);
+        REQUIRE(again.winner == report.matches[3].winner);
+        REQUIRE(again.ticks == report.matches[3].ticks);
+        MatchResult short_match = runner.run_match(0, 1, 3);
+        REQUIRE(short_match.ticks == 3);
+        REQUIRE(short_match.winner == std::nullopt);
+        REQUIRE(short_match.error.empty());
+    }
     SECTION("Reading & writing save files") {
         Game game{"../../data/Units/", "../../data/Skills/", "../../data/Schools/", "../../data/Summoners/Student.json", "../../data/Summoners/D.S.Telyakovskii.json", "../../data/Field/GameField.json", "../../data/Saves/Save.json"};
         REQUIRE(game.teammates().size() == 2);
@@ -257,6 +868,111 @@ TEST_CASE("Game") {
         REQUIRE(game.teammates().size() == 2);
         REQUIRE(game.enemies().size() == 2);
     }
+    SECTION("Streaming save reader") {
+        auto path = std::filesystem::temp_directory_path() / "summoners_test_stream.json";
+        std::ofstream(path) << R"({"version":{"major":1,"units":[0]},"units":[)"
+            << R"({"type":"Summoner","name":"MEPhI student","hp":1.5,"xp":52,"team":"player","x":5,"y":6,"extra":{"units":[{"type":"Moral"}]}},)"
+            << R"({"type":"Kamikaze","name":"Academic Leave","hp":2.0,"team":"player","x":7,"y":7},)"
+            << R"({"type":"Amoral","name":"Imaginary Unit","hp":6.5,"team":"enemy","x":23,"y":25,"tags":["a",null,true]}]})";
+        Game game{"../../data/Units/", "../../data/Skills/", "../../data/Schools/", "../../data/Summoners/Student.json", "../../data/Summoners/D.S.Telyakovskii.json", "../../data/Field/GameField.json"};
+        game.read_save(path.string(), "/nonexistent/Units/");
+        REQUIRE(game.teammates().size() == 2);
+        REQUIRE(game.enemies().size() == 2);
+        auto& player = static_pointer_cast<Summoner>(game.teammates()[0])->characteristics();
+        REQUIRE(player.left_XP == 52.0);
+        REQUIRE(game.teammates()[0]->current_HP() == 1.5);
+        REQUIRE(game.teammates()[0]->x() == 5);
+        auto enemy = game.find_enemy(23, 25, PLAYER);
+        REQUIRE(enemy->current_HP() == 6.5);
+        REQUIRE(enemy->amount() == 2);
+        std::ofstream(path) << R"({"units":[{"type":"Dragon","name":"Red Bull","hp":1,"team":"enemy","x":30,"y":30}]})";
+        REQUIRE_THROWS_AS(game.read_save(path.string(), "../../data/Units/"), std::runtime_error);
+        std::ofstream(path) << R"({"units":[{"type":"Amoral","name":"Red)";
+        REQUIRE_THROWS_AS(game.read_save(path.string(), "../../data/Units/"), std::runtime_error);
+        std::filesystem::remove(path);
+    }
+    SECTION("Binary snapshots") {
+        std::string path = (std::filesystem::temp_directory_path() / "summoners_test_snapshot.sav").string();
+        Game game{"../../data/Units/", "../../data/Skills/", "../../data/Schools/", "../../data/Summoners/Student.json", "../../data/Summoners/D.S.Telyakovskii.json", "../../data/Field/GameField.json"};
+        const SchoolsTable& catalog = game.schools_table();
+        auto moral = Factory::create_moral_unit(catalog.find_unit("Wolfram Alpha"));
+        moral->morality() = 3.5;
+        game.deploy_unit(3, 4, moral, PLAYER);
+        game.deploy_unit(5, 6, Factory::create_kamikaze(catalog.find_unit("Academic Leave")), PLAYER);
+        auto ressurection = Factory::create_ressurection_unit(catalog.find_unit("Sweet Sleep"));
+        ressurection->current_HP() = 4.5;
+        ressurection->amount() = 5;
+        game.deploy_unit(20, 21, ressurection, ENEMY);
+        auto& player = static_pointer_cast<Summoner>(game.teammates()[0])->characteristics();
+        player.current_energy = 42.0;
+        player.left_XP = 7.0;
+        player.schools_knowledge["MSU"] = 3.0;
+        game.seed(99);
+        game.rng()();
+        game.write_snapshot(path);
+        REQUIRE(SaveFile::is_snapshot(path));
+        REQUIRE_FALSE(SaveFile::is_snapshot("../../data/Saves/Save.json"));
+        Game restored{"../../data/Units/", "../../data/Skills/", "../../data/Schools/", "../../data/Summoners/Student.json", "../../data/Summoners/D.S.Telyakovskii.json", "../../data/Field/GameField.json"};
+        restored.read_snapshot(path, "../../data/Units/");
+        REQUIRE(restored.teammates().size() == 3);
+        REQUIRE(restored.enemies().size() == 2);
+        REQUIRE(restored.rng().key() == game.rng().key());
+        REQUIRE(restored.rng().counter() == 1);
+        auto& restored_player = static_pointer_cast<Summoner>(restored.teammates()[0])->characteristics();
+        REQUIRE(restored_player.current_energy == 42.0);
+        REQUIRE(restored_player.left_XP == 7.0);
+        REQUIRE(restored_player.schools_knowledge.at("MSU") == 3.0);
+        REQUIRE(restored_player.schools_knowledge.at("MEPhI") == 25.0);
+        auto restored_moral = std::find_if(restored.teammates().begin(), restored.teammates().end(), [](const auto& unit){ return unit->kind() == MORAL; });
+        REQUIRE(restored_moral != restored.teammates().end());
+        REQUIRE(static_pointer_cast<MoralUnit>(*restored_moral)->morality() == 3.5);
+        REQUIRE((*restored_moral)->x() == 3);
+        REQUIRE(std::any_of(restored.teammates().begin(), restored.teammates().end(), [](const auto& unit){ return unit->kind() == KAMIKAZE; }));
+        auto restored_ressurection = restored.find_enemy(20, 21, PLAYER);
+        REQUIRE(restored_ressurection->kind() == RESSURECTION);
+        REQUIRE(restored_ressurection->current_HP() == 4.5);
+        REQUIRE(restored_ressurection->amount() == 5);
+        std::filesystem::resize_file(path, std::filesystem::file_size(path) - 8);
+        REQUIRE_THROWS_AS(SaveFile{path}, std::runtime_error);
+        std::filesystem::remove(path);
+    }
+    SECTION("Autosave") {
+        auto dir = std::filesystem::temp_directory_path() / "summoners_test_autosave";
+        std::filesystem::remove_all(dir);
+        SchoolsTable st{table};
+        Game game{st, field};
+        game.seed(3);
+        for (int i = 0; i < 6; ++i) {
+            game.deploy_unit(i, 0, Factory::create_moral_unit(ud1), PLAYER);
+            game.deploy_unit(39 - i, 39, Factory::create_amoral_unit(ud), ENEMY);
+        }
+        auto autosaver = std::make_shared<Autosaver>(dir.string(), 2, 3);
+        game.set_autosaver(autosaver);
+        for (int tick = 0; tick < 10; ++tick) {
+            game.do_tick();
+        }
+        autosaver->flush();
+        REQUIRE(autosaver->last_error().empty());
+        REQUIRE(autosaver->written() + autosaver->dropped() == 5);
+        size_t files = std::distance(std::filesystem::directory_iterator(dir), std::filesystem::directory_iterator());
+        REQUIRE(files == std::min<size_t>(autosaver->written(), 3));
+        REQUIRE(autosaver->last_path().ends_with("0000000010" SAVE_FILE_EXTENSION));
+        SaveFile save{autosaver->last_path()};
+        REQUIRE(save.header().ticks == 10);
+        REQUIRE(save.header().rng_key == game.rng().key());
+        REQUIRE(save.units().size() == game.teammates().size() + game.enemies().size());
+        REQUIRE_FALSE(Autosaver(dir.string(), 0).due(10));
+        {
+            Autosaver restarted(dir.string(), 2, 3);
+            restarted.submit(2, std::make_shared<SaveSnapshot>(game.take_snapshot()));
+            restarted.flush();
+            REQUIRE(std::filesystem::exists(restarted.last_path()));
+            REQUIRE(std::filesystem::exists(autosaver->last_path()));
+        }
+        game.set_autosaver(nullptr);
+        autosaver.reset();
+        std::filesystem::remove_all(dir);
+    }
     SECTION("Kamikaze") {
         SchoolsTable st{table};
         Game game{st, field};
@@ -272,3 +988,68 @@ TEST_CASE("Game") {
         }
     }
 }
+
+TEST_CASE("Spatial index benchmark", "[.][benchmark]") {
+    UnitDescriptor ud{"Calculus", "MSU", 0.5, 4, 2.0, 2.0, 3, 0.5, 2.0, std::nullopt};
+    const int side = 1024;
+    std::mt19937 gen{42};
+    std::uniform_int_distribution<int> coordinate(0, side - 1);
+    std::vector<std::shared_ptr<BaseUnit>> units;
+    SpatialIndex index{side, side};
+    for (int i = 0; i < 10000; ++i) {
+        auto unit = Factory::create_amoral_unit(ud);
+        unit->x() = coordinate(gen);
+        unit->y() = coordinate(gen);
+        index.insert(i, unit->x(), unit->y());
+        units.push_back(unit);
+    }
+    int x = coordinate(gen);
+    int y = coordinate(gen);
+    REQUIRE(SpatialIndex::distance2(x, y, units[index.nearest(x, y)]->x(), units[index.nearest(x, y)]->y()) == SpatialIndex::distance2(x, y, (*std::min_element(units.begin(), units.end(), [=](auto u_a, auto u_b){ return sqrt(pow(x - u_a->x(), 2) + pow(y - u_a->y(), 2)) < sqrt(pow(x - u_b->x(), 2) + pow(y - u_b->y(), 2)); }))->x(), (*std::min_element(units.begin(), units.end(), [=](auto u_a, auto u_b){ return sqrt(pow(x - u_a->x(), 2) + pow(y - u_a->y(), 2)) < sqrt(pow(x - u_b->x(), 2) + pow(y - u_b->y(), 2)); }))->y()));
+    BENCHMARK("Linear scan, 10k units") {
+        return *std::min_element(units.begin(), units.end(), [=](auto u_a, auto u_b){ return sqrt(pow(x - u_a->x(), 2) + pow(y - u_a->y(), 2)) < sqrt(pow(x - u_b->x(), 2) + pow(y - u_b->y(), 2)); });
+    };
+    BENCHMARK("Bucket grid, 10k units") {
+        return index.nearest(x, y);
+    };
+    BENCHMARK("Bucket grid, 16 nearest of 10k units") {
+        return index.k_nearest(x, y, 16);
+    };
+}
+
+TEST_CASE("Unit dispatch benchmark", "[.][benchmark]") {
+    UnitDescriptor ud{"Calculus", "MSU", 0.5, 4, 2.0, 2.0, 3, 0.5, 2.0, std::nullopt};
+    UnitDescriptor ud1{"Commision", "MEPhI", 0.7, 4, 1.0, 2.0, 3, 0.5, 2.0, 0.0};
+    SchoolsTable st;
+    Game game{st, Grid<GameCell>{128, 128}};
+    for (int i = 0; i < 10000; ++i) {
+        std::shared_ptr<BaseUnit> unit;
+        switch (i % 3) {
+            case 0: unit = Factory::create_moral_unit(ud1); break;
+            case 1: unit = Factory::create_amoral_unit(ud); break;
+            default: unit = Factory::create_ressurection_unit(ud); break;
+        }
+        game.deploy_unit(i % 128, i / 128, unit, PLAYER);
+    }
+    const auto& units = game.teammates();
+    BENCHMARK("Virtual take_damage, 10k units") {
+        for (auto& unit : units) {
+            unit->take_damage(0.0);
+        }
+    };
+    BENCHMARK("Static take_damage, 10k units") {
+        for (auto& unit : units) {
+            UnitDispatch::take_damage(*unit, 0.0);
+        }
+    };
+    BENCHMARK("Virtual make_turn, 10k units") {
+        for (auto& unit : units) {
+            unit->make_turn(game, PLAYER);
+        }
+    };
+    BENCHMARK("Static make_turn, 10k units") {
+        for (auto& unit : units) {
+            UnitDispatch::make_turn(*unit, game, PLAYER);
+        }
+    };
+}